@@ -651,11 +651,21 @@ SparseBitmap<T, InternalTypes>::bit_or(SparseBitmap<T, InternalTypes>** bitmap1,
 	{
 		if (destFound)
 		{
-			// See if we need to skip value in destination tree
+			// See if we need to skip value in destination tree.
+			// If a single step is not enough, search for the source
+			// value as there may be a long run of values to skip.
 			if (destValue < sourceValue)
 			{
 				if ((destFound = dest->tree.getNext()))
+				{
 					destValue = dest->tree.current().start_value;
+
+					if (destValue < sourceValue &&
+						(destFound = dest->tree.locate(locGreatEqual, sourceValue)))
+					{
+						destValue = dest->tree.current().start_value;
+					}
+				}
 				continue;
 			}
 
@@ -774,11 +784,21 @@ SparseBitmap<T, InternalTypes>::bit_and(SparseBitmap<T, InternalTypes>** bitmap1
 	{
 		if (sourceFound)
 		{
-			// See if we need to skip value in destination tree
+			// See if we need to skip value in source tree.
+			// If a single step is not enough, search for the destination
+			// value as there may be a long run of values to skip.
 			if (sourceValue < destValue)
 			{
 				if ((sourceFound = source->tree.getNext()))
+				{
 					sourceValue = source->tree.current().start_value;
+
+					if (sourceValue < destValue &&
+						(sourceFound = source->tree.locate(locGreatEqual, destValue)))
+					{
+						sourceValue = source->tree.current().start_value;
+					}
+				}
 				continue;
 			}
 
@@ -173,6 +173,9 @@ const Config::ConfigEntry Config::entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,		"TraceDSQL",				(ConfigValue) 0},		// bitmask
 	{TYPE_BOOLEAN,		"LegacyHash",				(ConfigValue) true},	// let use old passwd hash verification
 	{TYPE_STRING,		"GCPolicy",					(ConfigValue) NULL},	// garbage collection policy
+	{TYPE_INTEGER,		"GCWorkers",				(ConfigValue) 1},		// background garbage collector threads
+	{TYPE_INTEGER,		"SweepWorkers",				(ConfigValue) 1},		// sweep threads
+	{TYPE_INTEGER,		"IndexBuildWorkers",		(ConfigValue) 1},		// index key extraction threads
 	{TYPE_BOOLEAN,		"Redirection",				(ConfigValue) false},
 	{TYPE_INTEGER,		"DatabaseGrowthIncrement",	(ConfigValue) 128 * 1048576},	// bytes
 	{TYPE_INTEGER,		"FileSystemCacheThreshold",	(ConfigValue) 65536},	// page buffers
@@ -660,6 +663,24 @@ const char *Config::getGCPolicy() const
 	return rc;
 }
 
+int Config::getGCWorkers() const
+{
+	int rc = get<int>(KEY_GC_WORKERS);
+	return rc < 1 ? 1 : rc;
+}
+
+int Config::getSweepWorkers() const
+{
+	int rc = get<int>(KEY_SWEEP_WORKERS);
+	return rc < 1 ? 1 : rc;
+}
+
+int Config::getIndexBuildWorkers() const
+{
+	int rc = get<int>(KEY_INDEX_BUILD_WORKERS);
+	return rc < 1 ? 1 : rc;
+}
+
 bool Config::getRedirection()
 {
 	return (bool) getDefaultConfig()->values[KEY_REDIRECTION];
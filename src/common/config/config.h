@@ -120,6 +120,9 @@ public:
 		KEY_TRACE_DSQL,
 		KEY_LEGACY_HASH,
 		KEY_GC_POLICY,
+		KEY_GC_WORKERS,
+		KEY_SWEEP_WORKERS,
+		KEY_INDEX_BUILD_WORKERS,
 		KEY_REDIRECTION,
 		KEY_DATABASE_GROWTH_INCREMENT,
 		KEY_FILESYSTEM_CACHE_THRESHOLD,
@@ -324,6 +327,15 @@ public:
 	// GC policy
 	const char* getGCPolicy() const;
 
+	// Number of background garbage collector threads
+	int getGCWorkers() const;
+
+	// Number of threads sweeping the database
+	int getSweepWorkers() const;
+
+	// Number of threads extracting keys when an index is built
+	int getIndexBuildWorkers() const;
+
 	// Redirection
 	static bool getRedirection();
 
@@ -342,6 +342,7 @@ public:
 		SRAM_TRACE_CONFIG = 0xFC,
 		SRAM_TRACE_LOG = 0xFB,
 		SRAM_MAPPING_RESET = 0xFA,
+		SRAM_TRANSACTION_STATES = 0xF9,
 	};
 
 protected:
@@ -44,7 +44,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_SUPPORTS_HASH_GROUPING;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -110,7 +110,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_SUPPORTS_HASH_GROUPING;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -141,7 +141,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_SUPPORTS_HASH_GROUPING;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -172,7 +172,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_SUPPORTS_HASH_GROUPING;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
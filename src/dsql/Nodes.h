@@ -925,6 +925,8 @@ public:
 	static const unsigned CAP_WANTS_AGG_CALLS		= 0x04;
 	// wants winPass call in a window
 	static const unsigned CAP_WANTS_WIN_PASS_CALL	= 0x08;
+	// keeps its whole state in the impure value, so groups may be aggregated in a hash table
+	static const unsigned CAP_SUPPORTS_HASH_GROUPING	= 0x10;
 
 protected:
 	struct AggInfo
@@ -334,4 +334,89 @@ namespace Jrd
 		reset();
 	}
 
+	void Database::ActiveSnapshots::add(TraNumber number, TraNumber oldest)
+	{
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, "Database::ActiveSnapshots::add");
+
+		FB_SIZE_T pos;
+		if (m_snapshots.find(number, pos))
+			m_snapshots[pos].oldest = oldest;
+		else
+		{
+			Snapshot snapshot;
+			snapshot.number = number;
+			snapshot.oldest = oldest;
+			snapshot.retained = false;
+			m_snapshots.insert(pos, snapshot);
+		}
+	}
+
+	void Database::ActiveSnapshots::remove(TraNumber number)
+	{
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, "Database::ActiveSnapshots::remove");
+
+		FB_SIZE_T pos;
+		if (m_snapshots.find(number, pos))
+		{
+			if (m_snapshots[pos].retained)
+				m_retained--;
+
+			m_snapshots.remove(pos);
+		}
+	}
+
+	void Database::ActiveSnapshots::retain(TraNumber number)
+	{
+		// After commit/rollback retaining the snapshot keeps its number but
+		// goes on under new transaction numbers, and sees what it has done
+		// under the previous ones. Such numbers are newer than the snapshot
+		// number, so the snapshot doesn't tell which versions it needs anymore.
+
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, "Database::ActiveSnapshots::retain");
+
+		FB_SIZE_T pos;
+		if (m_snapshots.find(number, pos) && !m_snapshots[pos].retained)
+		{
+			m_snapshots[pos].retained = true;
+			m_retained++;
+		}
+	}
+
+	void Database::ActiveSnapshots::markNeeded(const TraNumber* writers, FB_SIZE_T count, bool* needed)
+	{
+		// Writers of the record versions are given newest first. Every snapshot
+		// reads the first version written by a transaction it considers committed,
+		// so it needs the versions up to the first one it surely sees. The primary
+		// version is always needed by those reading the latest committed data.
+
+		if (count)
+			needed[0] = true;
+
+		SyncLockGuard guard(&m_sync, SYNC_SHARED, "Database::ActiveSnapshots::markNeeded");
+
+		// While some snapshot has retained context, keep everything
+
+		if (m_retained)
+		{
+			for (FB_SIZE_T i = 0; i < count; i++)
+				needed[i] = true;
+
+			return;
+		}
+
+		for (const Snapshot* snapshot = m_snapshots.begin(); snapshot != m_snapshots.end(); ++snapshot)
+		{
+			for (FB_SIZE_T i = 0; i < count; i++)
+			{
+				if (writers[i] > snapshot->number)
+					continue;
+
+				needed[i] = true;
+
+				if (writers[i] < snapshot->oldest)
+					break;
+			}
+		}
+	}
+
 } // namespace
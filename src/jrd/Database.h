@@ -331,6 +331,40 @@ public:
 		bool active;
 	};
 
+	// Snapshots of the transactions running in this process. Garbage
+	// collection uses them to find back versions which are younger than
+	// the oldest snapshot but still invisible to every transaction.
+	class ActiveSnapshots
+	{
+		struct Snapshot
+		{
+			TraNumber number;		// newer transactions are invisible to the snapshot
+			TraNumber oldest;		// older transactions are visible, zero if not known yet
+			bool retained;			// context was retained, own newer transactions are visible
+
+			static const TraNumber& generate(const Snapshot& item)
+			{
+				return item.number;
+			}
+		};
+
+	public:
+		explicit ActiveSnapshots(MemoryPool& p)
+			: m_snapshots(p), m_retained(0)
+		{}
+
+		void add(TraNumber number, TraNumber oldest);
+		void remove(TraNumber number);
+		void retain(TraNumber number);
+		void markNeeded(const TraNumber* writers, FB_SIZE_T count, bool* needed);
+
+	private:
+		Firebird::SyncObject m_sync;
+		Firebird::SortedArray<Snapshot, Firebird::EmptyStorage<Snapshot>,
+			TraNumber, Snapshot> m_snapshots;
+		ULONG m_retained;		// snapshots with retained context
+	};
+
 	static Database* create(Firebird::IPluginConfig* pConf, JProvider* provider, bool shared)
 	{
 		Firebird::MemoryStats temp_stats;
@@ -448,6 +482,9 @@ public:
 	Firebird::Semaphore dbb_gc_sem;		// Event to wake up garbage collector
 	Firebird::Semaphore dbb_gc_init;	// Event for initialization garbage collector
 	ThreadFinishSync<Database*> dbb_gc_fini;	// Sync for finalization garbage collector
+	Firebird::Semaphore dbb_gc_workers_sem;		// Event to wake up garbage collector helpers
+	ActiveSnapshots dbb_active_snapshots;		// Snapshots of local transactions (SuperServer only)
+	Firebird::AtomicCounter dbb_index_drops;	// Index trees deleted, voids leaf hints of all attachments
 
 	Firebird::MemoryStats dbb_memory_stats;
 	RuntimeStatistics dbb_stats;
@@ -522,6 +559,7 @@ private:
 		dbb_pools(*p, 4),
 		dbb_sort_buffers(*p),
 		dbb_gc_fini(*p, garbage_collector, THREAD_medium),
+		dbb_active_snapshots(*p),
 		dbb_stats(*p),
 		dbb_lock_owner_id(getLockOwnerId()),
 		dbb_tip_cache(NULL),
@@ -572,6 +610,7 @@ public:
 	void clearSweepFlags(thread_db* tdbb);
 
 	static void garbage_collector(Database* dbb);
+	static void gc_worker(Database* dbb);
 	void exceptionHandler(const Firebird::Exception& ex, ThreadFinishSync<Database*>::ThreadRoutine* routine);
 
 private:
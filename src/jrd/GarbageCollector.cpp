@@ -29,10 +29,16 @@ using namespace Firebird;
 
 namespace Jrd {
 
+// Index statistics of a relation are refreshed after this many record
+// changes or after changes of a fifth of its records, whichever is more
+const FB_UINT64 STATS_MIN_CHANGES = 10000;
+const FB_UINT64 STATS_CHANGE_RATIO = 5;
+
 
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_backlog = 0;
 }
 
 
@@ -58,12 +64,17 @@ TraNumber GarbageCollector::RelationData::addPage(const ULONG pageno, const TraN
 		return findTran;
 
 	m_pages.add(PageTran(pageno, tranid));
+	m_backlog++;
 	return tranid;
 }
 
 
-void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, PageBitmap** bm)
+void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, PageBitmap** bm,
+	ULONG maxPages)
 {
+	// If maxPages is given, stop after that many pages were put into the bitmap,
+	// leaving the rest for the next call
+
 	PageTranMap::Accessor pages(&m_pages);
 
 	bool next = pages.getFirst();
@@ -76,6 +87,10 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 				PBM_SET(&m_pool, bm, pages.current().pageno);
 			}
 			next = pages.fastRemove();
+			m_backlog--;
+
+			if (maxPages && !--maxPages)
+				break;
 		}
 		else
 			next = pages.getNext();
@@ -83,6 +98,12 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 }
 
 
+FB_UINT64 GarbageCollector::RelationData::statsThreshold() const
+{
+	return MAX(STATS_MIN_CHANGES, m_records / STATS_CHANGE_RATIO);
+}
+
+
 GarbageCollector::~GarbageCollector()
 {
 	SyncLockGuard exGuard(&m_sync, SYNC_EXCLUSIVE, "GarbageCollector::~GarbageCollector");
@@ -121,7 +142,8 @@ TraNumber GarbageCollector::addPage(const USHORT relID, const ULONG pageno, cons
 }
 
 
-PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &relID)
+PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &relID,
+	const ULONG maxPages)
 {
 	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getPages");
 
@@ -131,6 +153,34 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 		return NULL;
 	}
 
+	// Serve the relation with the largest backlog first: most probably it has
+	// the longest version chains, slowing down readers. Backlog counters are
+	// read without relation sync - we don't require exact precision here.
+
+	FB_SIZE_T busiest = 0;
+	for (FB_SIZE_T pos = 1; pos < m_relations.getCount(); pos++)
+	{
+		if (m_relations[pos]->m_backlog > m_relations[busiest]->m_backlog)
+			busiest = pos;
+	}
+
+	if (m_relations[busiest]->m_backlog)
+	{
+		RelationData* relData = m_relations[busiest];
+		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getPages");
+
+		PageBitmap* bm = NULL;
+		relData->swept(oldest_snapshot, &bm, maxPages);
+
+		if (bm)
+		{
+			relID = relData->getRelID();
+			return bm;
+		}
+	}
+
+	// Pages of the busiest relation are not collectable yet, look at the others
+
 	FB_SIZE_T pos;
 	if (!m_relations.find(m_nextRelID, pos) && (pos == m_relations.getCount()))
 		pos = 0;
@@ -141,7 +191,7 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getPages");
 
 		PageBitmap* bm = NULL;
-		relData->swept(oldest_snapshot, &bm);
+		relData->swept(oldest_snapshot, &bm, maxPages);
 
 		if (bm)
 		{
@@ -156,6 +206,20 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 }
 
 
+FB_UINT64 GarbageCollector::getBacklog()
+{
+	// Returns number of data pages waiting for garbage collection
+
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getBacklog");
+
+	FB_UINT64 backlog = 0;
+	for (FB_SIZE_T pos = 0; pos < m_relations.getCount(); pos++)
+		backlog += m_relations[pos]->m_backlog;
+
+	return backlog;
+}
+
+
 void GarbageCollector::removeRelation(const USHORT relID)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::removeRelation");
@@ -192,6 +256,59 @@ void GarbageCollector::sweptRelation(const TraNumber oldest_snapshot, const USHO
 }
 
 
+bool GarbageCollector::addChanges(const USHORT relID, const ULONG count)
+{
+	// Returns true when the relation just became due for index statistics refresh
+
+	Sync syncGC(&m_sync, "GarbageCollector::addChanges");
+	RelationData* relData = getRelData(syncGC, relID, true);
+
+	SyncLockGuard syncData(&relData->m_sync, SYNC_SHARED, "GarbageCollector::addChanges");
+	syncGC.unlock();
+
+	const FB_UINT64 threshold = relData->statsThreshold();
+	const FB_UINT64 before = (FB_UINT64) relData->m_changes.exchangeAdd(count);
+
+	return (before < threshold && before + count >= threshold);
+}
+
+
+bool GarbageCollector::getStatsRelation(USHORT &relID)
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getStatsRelation");
+
+	for (FB_SIZE_T pos = 0; pos < m_relations.getCount(); pos++)
+	{
+		RelationData* relData = m_relations[pos];
+		SyncLockGuard syncData(&relData->m_sync, SYNC_SHARED, "GarbageCollector::getStatsRelation");
+
+		if ((FB_UINT64) relData->m_changes.value() >= relData->statsThreshold())
+		{
+			relData->m_changes.setValue(0);
+			relID = relData->getRelID();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void GarbageCollector::statsRefreshed(const USHORT relID, const FB_UINT64 records)
+{
+	Sync syncGC(&m_sync, "GarbageCollector::statsRefreshed");
+
+	RelationData* relData = getRelData(syncGC, relID, false);
+	if (relData)
+	{
+		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::statsRefreshed");
+
+		syncGC.unlock();
+		relData->m_records = records;
+	}
+}
+
+
 GarbageCollector::RelationData* GarbageCollector::getRelData(Sync &sync, const USHORT relID,
 	bool allowCreate)
 {
@@ -27,6 +27,7 @@
 #include "../common/classes/array.h"
 #include "../common/classes/GenericMap.h"
 #include "../common/classes/SyncObject.h"
+#include "../common/classes/fb_atomic.h"
 #include "../jrd/sbm.h"
 
 
@@ -45,10 +46,15 @@ public:
 	~GarbageCollector();
 
 	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid);
-	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID);
+	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID, const ULONG maxPages = 0);
+	FB_UINT64 getBacklog();
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
 
+	bool addChanges(const USHORT relID, const ULONG count);
+	bool getStatsRelation(USHORT &relID);
+	void statsRefreshed(const USHORT relID, const FB_UINT64 records);
+
 private:
 	struct PageTran
 	{
@@ -77,7 +83,7 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_relID(relID), m_backlog(0), m_records(0)
 		{}
 
 		~RelationData()
@@ -87,7 +93,8 @@ private:
 
 		TraNumber addPage(const ULONG pageno, const TraNumber tranid);
 		TraNumber findPage(const ULONG pageno, const TraNumber tranid);
-		void swept(const TraNumber oldest_snapshot, PageBitmap** bm = NULL);
+		void swept(const TraNumber oldest_snapshot, PageBitmap** bm = NULL, ULONG maxPages = 0);
+		FB_UINT64 statsThreshold() const;
 
 		USHORT getRelID() const
 		{
@@ -105,6 +112,9 @@ private:
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
 		USHORT m_relID;
+		ULONG m_backlog;					// number of pages waiting for garbage collection
+		Firebird::AtomicCounter m_changes;	// record changes since index statistics refresh
+		FB_UINT64 m_records;				// estimated cardinality at last refresh
 	};
 
 	typedef	Firebird::SortedArray<
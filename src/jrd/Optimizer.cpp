@@ -230,6 +230,7 @@ IndexScratch::IndexScratch(MemoryPool& p, thread_db* tdbb, index_desc* ix,
 	upperCount = 0;
 	nonFullMatchedSegments = 0;
 	fuzzy = false;
+	skipScan = false;
 
 	segments.grow(idx->idx_count);
 
@@ -279,6 +280,7 @@ IndexScratch::IndexScratch(MemoryPool& p, const IndexScratch& scratch) :
 	upperCount = scratch.upperCount;
 	nonFullMatchedSegments = scratch.nonFullMatchedSegments;
 	fuzzy = scratch.fuzzy;
+	skipScan = scratch.skipScan;
 	idx = scratch.idx;
 
 	// Allocate needed segments
@@ -669,8 +671,8 @@ void OptimizerRetrieval::analyzeNavigation()
 		// in the exact same order
 
 		const IndexScratchSegment* const* segment = indexScratch->segments.begin();
-		const IndexScratchSegment* const* const end_segment =
-			segment + MIN(indexScratch->lowerCount, indexScratch->upperCount);
+		const IndexScratchSegment* const* const end_segment = segment +
+			(indexScratch->skipScan ? 0 : MIN(indexScratch->lowerCount, indexScratch->upperCount));
 		int equalSegments = 0;
 
 		for (; segment < end_segment; segment++)
@@ -807,8 +809,10 @@ void OptimizerRetrieval::analyzeNavigation()
 			navigationCandidate = indexScratch;
 		else
 		{
-			int count1 = MAX(indexScratch->lowerCount, indexScratch->upperCount);
-			int count2 = MAX(navigationCandidate->lowerCount, navigationCandidate->upperCount);
+			int count1 = indexScratch->skipScan ? 0 :
+				MAX(indexScratch->lowerCount, indexScratch->upperCount);
+			int count2 = navigationCandidate->skipScan ? 0 :
+				MAX(navigationCandidate->lowerCount, navigationCandidate->upperCount);
 
 			if (count1 > count2)
 				navigationCandidate = indexScratch;
@@ -830,6 +834,16 @@ void OptimizerRetrieval::analyzeNavigation()
 			}
 		}
 	}
+
+	// A skip scan cannot deliver the keys in order, so the navigational
+	// walk has to go through the whole index instead
+	if (navigationCandidate && navigationCandidate->skipScan)
+	{
+		navigationCandidate->skipScan = false;
+		navigationCandidate->lowerCount = 0;
+		navigationCandidate->upperCount = 0;
+		navigationCandidate->selectivity = MAXIMUM_SELECTIVITY;
+	}
 }
 
 void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversions,
@@ -858,8 +872,16 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 		scratch.upperCount = 0;
 		scratch.nonFullMatchedSegments = MAX_INDEX_SEGMENTS + 1;
 		scratch.fuzzy = false;
+		scratch.skipScan = false;
 
-		if (scratch.candidate)
+		if (!scratch.candidate)
+		{
+			InversionCandidate* const invCandidate = makeSkipScanCandidate(&scratch, scope);
+
+			if (invCandidate)
+				inversions->add(invCandidate);
+		}
+		else
 		{
 			matches.clear();
 			scratch.selectivity = MAXIMUM_SELECTIVITY;
@@ -975,6 +997,21 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 							break;
 					}
 
+					// A range over the leading segment may be estimated
+					// using the index itself, if its bounds are known
+					if (j == 0 && (segment->scanType == segmentScanBetween ||
+						segment->scanType == segmentScanLess ||
+						segment->scanType == segmentScanGreater))
+					{
+						const double rangeSelectivity = getRangeSelectivity(&scratch, segment);
+
+						if (rangeSelectivity > 0)
+						{
+							selectivity = rangeSelectivity;
+							factor = 0;
+						}
+					}
+
 					// Adjust the compound selectivity using the reduce factor.
 					// It should be better than the previous segment but worse
 					// than a full match.
@@ -1033,6 +1070,154 @@ void OptimizerRetrieval::getInversionCandidates(InversionCandidateList* inversio
 	}
 }
 
+double OptimizerRetrieval::getRangeSelectivity(const IndexScratch* indexScratch,
+	const IndexScratchSegment* segment) const
+{
+/**************************************
+ *
+ *	g e t R a n g e S e l e c t i v i t y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the selectivity of a range scan over the leading
+ *	index segment, if its bounds are literals.
+ *	Return zero if there is no estimate.
+ *
+ **************************************/
+	const LiteralNode* const lower = nodeAs<LiteralNode>(segment->lowerValue);
+	const LiteralNode* const upper = nodeAs<LiteralNode>(segment->upperValue);
+
+	if ((segment->lowerValue && !lower) || (segment->upperValue && !upper) || (!lower && !upper))
+		return 0;
+
+	return BTR_range_selectivity(tdbb, relation, indexScratch->idx,
+		lower ? &lower->litDesc : NULL, upper ? &upper->litDesc : NULL);
+}
+
+InversionCandidate* OptimizerRetrieval::makeSkipScanCandidate(IndexScratch* indexScratch,
+	USHORT scope) const
+{
+/**************************************
+ *
+ *	m a k e S k i p S c a n C a n d i d a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a compound index with its leading segment
+ *	unmatched can still be used by skipping that segment,
+ *	i.e. by scanning the matched second segment once per every
+ *	distinct leading value. This is worth only if there are
+ *	few such values.
+ *
+ **************************************/
+	const index_desc* const idx = indexScratch->idx;
+
+	if (idx->idx_count < 2 || (idx->idx_flags & (idx_descending | idx_expressn)))
+		return NULL;
+
+	const IndexScratchSegment* const segment = indexScratch->segments[1];
+
+	if (segment->scope != scope || indexScratch->segments[0]->scanType != segmentScanNone)
+		return NULL;
+
+	// The leading segment selectivity tells us the number of its distinct values,
+	// so it's a must. Without statistics, the skip scan is never considered.
+	const double leadingSelectivity = idx->idx_rpt[0].idx_selectivity;
+	const double compoundSelectivity = idx->idx_rpt[1].idx_selectivity;
+
+	if (leadingSelectivity <= 0 || compoundSelectivity <= 0 ||
+		leadingSelectivity * MAXIMUM_SKIP_SCAN_KEYS < MAXIMUM_SELECTIVITY)
+	{
+		return NULL;
+	}
+
+	const USHORT iType = idx->idx_rpt[1].idx_itype;
+
+	if (iType >= idx_first_intl_string && !(idx->idx_flags & idx_unique))
+	{
+		TextType* textType = INTL_texttype_lookup(tdbb, INTL_INDEX_TO_TEXT(iType));
+
+		if (textType->getFlags() & TEXTTYPE_SEPARATE_UNIQUE)
+			return NULL;
+	}
+
+	// Both bounds include the skipped leading segment
+	double factor = 0;
+	int lowerCount = 1, upperCount = 1;
+
+	switch (segment->scanType)
+	{
+		case segmentScanEqual:
+			lowerCount++;
+			upperCount++;
+			break;
+
+		case segmentScanBetween:
+			lowerCount++;
+			upperCount++;
+			factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
+			break;
+
+		case segmentScanLess:
+			upperCount++;
+			factor = REDUCE_SELECTIVITY_FACTOR_LESS;
+			break;
+
+		case segmentScanGreater:
+			lowerCount++;
+			factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
+			break;
+
+		case segmentScanStarting:
+			lowerCount++;
+			upperCount++;
+			factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
+			break;
+
+		default:
+			return NULL;
+	}
+
+	// Estimate the selectivity of the second segment alone, then adjust it
+	// for the range scans the same way as for the regular index scans
+	double selectivity = MIN(compoundSelectivity / leadingSelectivity, MAXIMUM_SELECTIVITY);
+	selectivity += (MAXIMUM_SELECTIVITY - selectivity) * factor;
+
+	indexScratch->scopeCandidate = true;
+	indexScratch->skipScan = true;
+	indexScratch->lowerCount = lowerCount;
+	indexScratch->upperCount = upperCount;
+	indexScratch->selectivity = selectivity;
+	indexScratch->nonFullMatchedSegments =
+		idx->idx_count - (segment->scanType == segmentScanEqual ? 2 : 1);
+
+	const double leadingKeys = MAXIMUM_SELECTIVITY / leadingSelectivity;
+
+	InversionCandidate* invCandidate = FB_NEW_POOL(pool) InversionCandidate(pool);
+	invCandidate->selectivity = selectivity;
+	// Calculate the cost (only index pages) for this index, every leading
+	// value requires two descents: to find it and to find the range start
+	invCandidate->cost = DEFAULT_INDEX_COST * 2 * leadingKeys +
+		selectivity * indexScratch->cardinality;
+	invCandidate->nonFullMatchedSegments = indexScratch->nonFullMatchedSegments;
+	invCandidate->matchedSegments = 1;
+	invCandidate->indexes = 1;
+	invCandidate->scratch = indexScratch;
+	invCandidate->matches.join(segment->matches);
+
+	for (FB_SIZE_T k = 0; k < invCandidate->matches.getCount(); k++)
+	{
+		invCandidate->matches[k]->findDependentFromStreams(this,
+			&invCandidate->dependentFromStreams);
+	}
+
+	invCandidate->dependencies = (int) invCandidate->dependentFromStreams.getCount();
+
+	return invCandidate;
+}
+
 ValueExprNode* OptimizerRetrieval::findDbKey(ValueExprNode* dbkey, SLONG* position) const
 {
 /**************************************
@@ -1169,6 +1354,9 @@ InversionNode* OptimizerRetrieval::makeIndexScanNode(IndexScratch* indexScratch)
 	if (indexScratch->fuzzy)
 		retrieval->irb_generic |= irb_starting;	// Flag the need to use INTL_KEY_PARTIAL in btr.
 
+	if (indexScratch->skipScan)
+		retrieval->irb_generic |= irb_skip_scan;	// Leading segment values are NULLs here, skip them.
+
 	// This index is never used for IS NULL, thus we can ignore NULLs
 	// already at index scan. But this rule doesn't apply to nod_equiv
 	// which requires NULLs to be found in the index.
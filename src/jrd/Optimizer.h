@@ -67,6 +67,11 @@ const double THRESHOLD_CARDINALITY = 5.0;
 // so it's not included here.
 const int DEFAULT_INDEX_COST = 3;
 
+// Maximum number of distinct values of the leading segment of a compound
+// index which still allows to skip it while scanning the index.
+// Every distinct value costs an extra index descent.
+const double MAXIMUM_SKIP_SCAN_KEYS = 100.0;
+
 
 struct index_desc;
 class OptimizerBlk;
@@ -123,6 +128,7 @@ public:
 	int upperCount;					//
 	int nonFullMatchedSegments;		//
 	bool fuzzy;						// Need to use INTL_KEY_PARTIAL in btr lookups
+	bool skipScan;					// Leading segment is unmatched and skipped in btr lookups
 	double cardinality;				// Estimated cardinality when using the whole index
 
 	Firebird::Array<IndexScratchSegment*> segments;
@@ -189,11 +195,14 @@ protected:
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
+	double getRangeSelectivity(const IndexScratch* indexScratch,
+		const IndexScratchSegment* segment) const;
 	InversionCandidate* generateInversion();
 	void getInversionCandidates(InversionCandidateList* inversions,
 		IndexScratchList* indexScratches, USHORT scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
 	InversionCandidate* makeInversion(InversionCandidateList* inversions) const;
+	InversionCandidate* makeSkipScanCandidate(IndexScratch* indexScratch, USHORT scope) const;
 	bool matchBoolean(IndexScratch* indexScratch, BoolExprNode* boolean, USHORT scope) const;
 	InversionCandidate* matchDbKey(BoolExprNode* boolean) const;
 	InversionCandidate* matchOnIndexes(IndexScratchList* indexScratches,
@@ -26,43 +26,102 @@
 #include "../jrd/req.h"
 
 #include "../jrd/RecordBuffer.h"
+#include "../jrd/sqz.h"
 
 const char* const SCRATCH = "fb_recbuf_";
 
+// Records of this length and longer are stored compressed. They are usually
+// wide because of long VARCHARs whose unused tails compress very well.
+const ULONG MIN_COMPRESSED_LENGTH = 256;
+
 using namespace Jrd;
 
-RecordBuffer::RecordBuffer(MemoryPool& pool, const Format* format)
-	: count(0)
+RecordBuffer::RecordBuffer(MemoryPool& p, const Format* format)
+	: pool(p), count(0), length(0), offsets(NULL), buffer(p)
 {
 	space = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH);
 	record = FB_NEW_POOL(pool) Record(pool, format);
+
+	if (record->getLength() >= MIN_COMPRESSED_LENGTH)
+		offsets = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH);
 }
 
 RecordBuffer::~RecordBuffer()
 {
 	delete record;
 	delete space;
+	delete offsets;
 }
 
 offset_t RecordBuffer::store(const Record* new_record)
 {
-	const ULONG length = record->getLength();
-	fb_assert(new_record->getLength() == length);
+	const ULONG recordLength = record->getLength();
+	fb_assert(new_record->getLength() == recordLength);
+
+	if (!offsets)
+	{
+		space->write(count * recordLength, new_record->getData(), recordLength);
+		return count++;
+	}
+
+	// Compress the record and remember where it starts
 
-	space->write(count * length, new_record->getData(), length);
+	const Compressor dcc(pool, recordLength, new_record->getData());
+	const FB_SIZE_T packedLength = dcc.getPackedLength();
+
+	UCHAR* const packed = buffer.getBuffer(packedLength, false);
+	dcc.pack(new_record->getData(), packed);
+
+	offsets->write(count * sizeof(offset_t), &length, sizeof(offset_t));
+	space->write(length, packed, packedLength);
+	length += packedLength;
 
 	return count++;
 }
 
 bool RecordBuffer::fetch(offset_t position, Record* to_record)
 {
-	const ULONG length = record->getLength();
-	fb_assert(to_record->getLength() == length);
+	const ULONG recordLength = record->getLength();
+	fb_assert(to_record->getLength() == recordLength);
 
 	if (position >= count)
 		return false;
 
-	space->read(position * length, to_record->getData(), length);
+	if (!offsets)
+	{
+		space->read(position * recordLength, to_record->getData(), recordLength);
+		return true;
+	}
+
+	// The record ends where the next one starts
+
+	offset_t bounds[2];
+
+	if (position + 1 < count)
+		offsets->read(position * sizeof(offset_t), bounds, sizeof(bounds));
+	else
+	{
+		offsets->read(position * sizeof(offset_t), bounds, sizeof(offset_t));
+		bounds[1] = length;
+	}
+
+	const FB_SIZE_T packedLength = bounds[1] - bounds[0];
+
+	// Decompress directly from the temporary space if it's kept in memory
+
+	const UCHAR* packed = space->inMemory(bounds[0], packedLength);
+
+	if (!packed)
+	{
+		UCHAR* const data = buffer.getBuffer(packedLength, false);
+		space->read(bounds[0], data, packedLength);
+		packed = data;
+	}
+
+	UCHAR* const output = to_record->getData();
+
+	if (Compressor::unpack(packedLength, packed, recordLength, output) != output + recordLength)
+		BUGCHECK(179);	// msg 179 decompression overran buffer
 
 	return true;
 }
@@ -50,9 +50,13 @@ public:
 	bool fetch(offset_t, Record*);
 
 private:
+	MemoryPool& pool;
 	offset_t count;
+	offset_t length;			// size of the compressed data stored
 	Record* record;
 	TempSpace* space;
+	TempSpace* offsets;			// positions of the compressed records, NULL if not compressed
+	Firebird::UCharBuffer buffer;
 };
 
 } // namespace
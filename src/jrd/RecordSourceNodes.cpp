@@ -1630,12 +1630,29 @@ RecordSource* AggregateSourceNode::generate(thread_db* tdbb, OptimizerBlk* opt,
 		rse->flags |= RseNode::FLAG_OPT_FIRST_ROWS;
 	}
 
+	// Let the optimizer replace the GROUP BY sort with a hash table, unless the
+	// parent RSE expects the groups to be ordered or some aggregate cannot be hashed.
+	if (group && !orderedGroups && HashAggregate::isSupported(map))
+		rse->flags |= RseNode::FLAG_HASH_GROUPING;
+	else
+		rse->flags &= ~RseNode::FLAG_HASH_GROUPING;
+
 	RecordSource* const nextRsb = OPT_compile(tdbb, csb, rse, &deliverStack);
 
 	// allocate and optimize the record source block
 
-	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+	RecordSource* rsb;
+
+	if (rse->flags & RseNode::FLAG_HASH_GROUPING)
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) HashAggregate(tdbb, csb,
+			stream, &group->expressions, map, nextRsb);
+	}
+	else
+	{
+		rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
+			stream, (group ? &group->expressions : NULL), map, nextRsb);
+	}
 
 	if (rse->rse_aggregate)
 	{
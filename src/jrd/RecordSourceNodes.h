@@ -456,6 +456,7 @@ public:
 		  dsqlWindow(false),
 		  group(NULL),
 		  map(NULL),
+		  orderedGroups(false),
 		  rse(NULL)
 	{
 	}
@@ -505,6 +506,7 @@ public:
 	bool dsqlWindow;
 	NestConst<SortNode> group;
 	NestConst<MapNode> map;
+	bool orderedGroups;		// the parent relies on the groups being returned in order
 
 private:
 	NestConst<RseNode> rse;
@@ -652,6 +654,7 @@ public:
 	static const unsigned FLAG_SCROLLABLE		= 0x08;	// scrollable cursor
 	static const unsigned FLAG_DSQL_COMPARATIVE	= 0x10;	// transformed from DSQL ComparativeBoolNode
 	static const unsigned FLAG_OPT_FIRST_ROWS	= 0x20;	// optimize retrieval for first rows
+	static const unsigned FLAG_HASH_GROUPING	= 0x40;	// group using a hash table instead of a sort
 
 	explicit RseNode(MemoryPool& pool)
 		: TypedNode<RecordSourceNode, RecordSourceNode::TYPE_RSE>(pool),
@@ -524,4 +524,8 @@ void RelationPages::free(RelationPages*& nextFree)
 
 	dpMap.clear();
 	dpMapMark = 0;
+
+	memset(leafHints, 0, sizeof(leafHints));
+	leafHintGeneration = 0;
+	leafHintDrops = 0;
 }
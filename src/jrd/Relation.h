@@ -94,8 +94,12 @@ public:
 		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
 		  useCount(0),
 		  dpMap(pool),
-		  dpMapMark(0)
-	{}
+		  dpMapMark(0),
+		  leafHintGeneration(0),
+		  leafHintDrops(0)
+	{
+		memset(leafHints, 0, sizeof(leafHints));
+	}
 
 	inline SLONG addRef()
 	{
@@ -169,11 +173,64 @@ public:
 		dpMapMark -= minMark;
 	}
 
+	// Leaf page which took the last key of an index at its end, used by
+	// BTR_insert to skip the descent from the top of the tree for ordered
+	// keys. The hint is bound to the index root page it was found through
+	// and is void once an index page of the relation is released.
+
+	ULONG getLeafHint(USHORT indexId, ULONG indexRoot) const
+	{
+		const LeafHint& hint = leafHints[indexId % MAX_LEAF_HINTS];
+		return (hint.rootPage == indexRoot && hint.generation == leafHintGeneration) ?
+			hint.leafPage : 0;
+	}
+
+	void setLeafHint(USHORT indexId, ULONG indexRoot, ULONG leafPage)
+	{
+		LeafHint& hint = leafHints[indexId % MAX_LEAF_HINTS];
+		hint.rootPage = indexRoot;
+		hint.leafPage = leafPage;
+		hint.generation = leafHintGeneration;
+	}
+
+	void clearLeafHint(USHORT indexId)
+	{
+		leafHints[indexId % MAX_LEAF_HINTS].leafPage = 0;
+	}
+
+	void invalidateLeafHints()
+	{
+		++leafHintGeneration;
+	}
+
+	// Index trees are deleted using the relation pages of the dropping attachment,
+	// so hints taken before any tree of the database was deleted are void too
+	void syncLeafHints(ULONG indexDrops)
+	{
+		if (leafHintDrops != indexDrops)
+		{
+			leafHintDrops = indexDrops;
+			++leafHintGeneration;
+		}
+	}
+
 private:
 	RelationPages*	rel_next_free;
 	SLONG	useCount;
 
 	static const ULONG MAX_DPMAP_ITEMS = 64;
+	static const ULONG MAX_LEAF_HINTS = 16;
+
+	struct LeafHint
+	{
+		ULONG rootPage;
+		ULONG leafPage;
+		ULONG generation;
+	};
+
+	LeafHint leafHints[MAX_LEAF_HINTS];
+	ULONG leafHintGeneration;	// bumped when index pages are released
+	ULONG leafHintDrops;		// count of deleted index trees seen last
 
 	struct DPItem
 	{
@@ -246,6 +303,7 @@ public:
 	USHORT		rel_use_count;		// requests compiled with relation
 	USHORT		rel_sweep_count;	// sweep and/or garbage collector threads active
 	SSHORT		rel_scan_count;		// concurrent sequential scan count
+	Firebird::AtomicCounter	rel_mod_count;	// record changes not yet reported to garbage collector
 
 	Lock*		rel_existence_lock;	// existence lock, if any
 	Lock*		rel_partners_lock;	// partners lock
@@ -403,7 +461,7 @@ const ULONG REL_gc_lockneed				= 0x80000;	// gc lock should be acquired
 inline jrd_rel::jrd_rel(MemoryPool& p)
 	: rel_pool(&p), rel_flags(REL_gc_lockneed),
 	  rel_name(p), rel_owner_name(p), rel_security_name(p),
-	  rel_view_contexts(p), rel_gc_records(p), rel_ss_definer(false),
+	  rel_view_contexts(p), rel_gc_records(p), rel_mod_count(0), rel_ss_definer(false),
 	  rel_pages_base(p)
 {
 }
@@ -25,6 +25,7 @@
 #include "../jrd/dfw_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../jrd/idx_proto.h"
+#include "../jrd/sqz.h"
 #include "../jrd/vio_proto.h"
 
 #include "Savepoint.h"
@@ -39,8 +40,19 @@ UndoItem::UndoItem(jrd_tra* transaction, RecordNumber recordNumber, const Record
 	: m_number(recordNumber.getValue()), m_format(record->getFormat())
 {
 	fb_assert(m_format);
-	m_offset = transaction->getUndoSpace()->allocateSpace(m_format->fmt_length);
-	transaction->getUndoSpace()->write(m_offset, record->getData(), record->getLength());
+
+	// Record images are kept compressed the same way they're stored on disk,
+	// large transactions otherwise fill the undo space with trailing blanks
+	// and NULL fields
+
+	const Compressor dcc(*transaction->tra_pool, record->getLength(), record->getData());
+	m_length = (ULONG) dcc.getPackedLength();
+
+	HalfStaticArray<UCHAR, 2048> buffer;
+	dcc.pack(record->getData(), buffer.getBuffer(m_length));
+
+	m_offset = transaction->getUndoSpace()->allocateSpace(m_length);
+	transaction->getUndoSpace()->write(m_offset, buffer.begin(), m_length);
 }
 
 Record* UndoItem::setupRecord(jrd_tra* transaction) const
@@ -48,7 +60,12 @@ Record* UndoItem::setupRecord(jrd_tra* transaction) const
 	if (m_format)
 	{
 		Record* const record = transaction->getUndoRecord(m_format);
-		transaction->getUndoSpace()->read(m_offset, record->getData(), record->getLength());
+
+		HalfStaticArray<UCHAR, 2048> buffer;
+		UCHAR* const data = buffer.getBuffer(m_length);
+		transaction->getUndoSpace()->read(m_offset, data, m_length);
+
+		Compressor::unpack(m_length, data, record->getLength(), record->getData());
 		return record;
 	}
 
@@ -59,7 +76,7 @@ void UndoItem::release(jrd_tra* transaction)
 {
 	if (m_format)
 	{
-		transaction->getUndoSpace()->releaseSpace(m_offset, m_format->fmt_length);
+		transaction->getUndoSpace()->releaseSpace(m_offset, m_length);
 		m_format = NULL;
 	}
 }
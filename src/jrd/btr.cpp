@@ -187,12 +187,15 @@ namespace
 
 static ULONG add_node(thread_db*, WIN*, index_insertion*, temporary_key*, RecordNumber*,
 					  ULONG*, ULONG*);
+static inline USHORT common_prefix(const UCHAR*, const UCHAR*, USHORT);
 static void compress(thread_db*, const dsc*, temporary_key*, USHORT, bool, bool, USHORT);
 static USHORT compress_root(thread_db*, index_root_page*);
 static void copy_key(const temporary_key*, temporary_key*);
 static contents delete_node(thread_db*, WIN*, UCHAR*);
 static void delete_tree(thread_db*, USHORT, USHORT, PageNumber, PageNumber);
 static DSC* eval(thread_db*, const ValueExprNode*, DSC*, bool*);
+static void evaluate_range(thread_db*, const IndexRetrieval*, WIN*, btree_page*, index_desc&,
+						   temporary_key&, temporary_key&, RecordBitmap**, RecordBitmap*);
 static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
 
 static index_root_page* fetch_root(thread_db*, WIN*, const jrd_rel*, const RelationPages*);
@@ -209,10 +212,12 @@ static contents garbage_collect(thread_db*, WIN*, ULONG);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
 
+static bool insert_last_leaf(thread_db*, WIN*, index_insertion*, RelationPages*);
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
-						 RecordNumber*, ULONG*, ULONG*);
+						 RecordNumber*, ULONG*, ULONG*, bool = true, bool* = NULL);
 
 static INT64_KEY make_int64_key(SINT64, SSHORT);
+static void make_leading_key(thread_db*, const index_desc*, const dsc*, temporary_key*);
 #ifdef DEBUG_INDEXKEY
 static void print_int64_key(SINT64, SSHORT, INT64_KEY);
 #endif
@@ -222,6 +227,7 @@ static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
 				 const IndexRetrieval*, USHORT, temporary_key*,
 				 bool&, const temporary_key&);
+static void skip_scan(thread_db*, const IndexRetrieval*, RecordBitmap**, RecordBitmap*);
 static void update_selectivity(index_root_page*, USHORT, const SelectivityList&);
 static void checkForLowerKeySkip(bool&, const bool, const IndexNode&, const temporary_key&,
 								 const index_desc&, const IndexRetrieval*);
@@ -435,7 +441,7 @@ void BTR_create(thread_db* tdbb,
 }
 
 
-bool BTR_delete_index(thread_db* tdbb, WIN* window, USHORT id)
+bool BTR_delete_index(thread_db* tdbb, WIN* window, USHORT id, RelationPages* relPages)
 {
 /**************************************
  *
@@ -446,6 +452,8 @@ bool BTR_delete_index(thread_db* tdbb, WIN* window, USHORT id)
  * Functional description
  *	Delete an index if it exists.
  *	Return true if index tree was there.
+ *	The leaf hints of the relation pages are voided,
+ *	as the pages of the tree are released.
  *
  **************************************/
 	SET_TDBB(tdbb);
@@ -468,11 +476,17 @@ bool BTR_delete_index(thread_db* tdbb, WIN* window, USHORT id)
 		// remove the pointer to the top-level index page before we delete it
 		irt_desc->setRoot(0);
 		irt_desc->irt_flags = 0;
+
+		// other attachments inserting into the index hold the root page,
+		// they see the count changed once they find the tree gone
+		++tdbb->getDatabase()->dbb_index_drops;
 		const PageNumber prior = window->win_page;
 		const USHORT relation_id = root->irt_relation;
 
 		CCH_RELEASE(tdbb, window);
 		delete_tree(tdbb, relation_id, id, next, prior);
+
+		relPages->invalidateLeafHints();
 	}
 
 	return tree_exists;
@@ -515,6 +529,7 @@ bool BTR_description(thread_db* tdbb, jrd_rel* relation, index_root_page* root,
 	idx->idx_primary_index = 0;
 	idx->idx_expression = NULL;
 	idx->idx_expression_statement = NULL;
+	idx->idx_expression_fields = NULL;
 
 	// pick up field ids and type descriptions for each of the fields
 	const UCHAR* ptr = (UCHAR*) root + irt_desc->irt_desc;
@@ -682,6 +697,12 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
  **************************************/
 	SET_TDBB(tdbb);
 
+	if (retrieval->irb_generic & irb_skip_scan)
+	{
+		skip_scan(tdbb, retrieval, bitmap, bitmap_and);
+		return;
+	}
+
 	// Remove ignore_nulls flag for older ODS
 	//const Database* dbb = tdbb->getDatabase();
 
@@ -695,142 +716,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 	upper.key_length = 0;
 	btree_page* page = BTR_find_page(tdbb, retrieval, &window, &idx, &lower, &upper);
 
-	const bool descending = (idx.idx_flags & idx_descending);
-	bool skipLowerKey = (retrieval->irb_generic & irb_exclude_lower);
-	const bool partLower = (retrieval->irb_lower_count < idx.idx_count);
-
-	// If there is a starting descriptor, search down index to starting position.
-	// This may involve sibling buckets if splits are in progress.  If there
-	// isn't a starting descriptor, walk down the left side of the index.
-	USHORT prefix;
-	UCHAR* pointer;
-	if (retrieval->irb_lower_count)
-	{
-		while (!(pointer = find_node_start_point(page, &lower, 0, &prefix,
-			idx.idx_flags & idx_descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
-		{
-			page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-		}
-
-		// Compute the number of matching characters in lower and upper bounds
-		if (retrieval->irb_upper_count)
-		{
-			prefix = IndexNode::computePrefix(upper.key_data, upper.key_length,
-											  lower.key_data, lower.key_length);
-		}
-
-		if (skipLowerKey)
-		{
-			IndexNode node;
-			node.readNode(pointer, true);
-
-			if ((lower.key_length == node.prefix + node.length) ||
-				(lower.key_length <= node.prefix + node.length) && partLower)
-			{
-				const UCHAR* p = node.data, *q = lower.key_data + node.prefix;
-				const UCHAR* const end = lower.key_data + lower.key_length;
-				while (q < end)
-				{
-					if (*p++ != *q++)
-					{
-						skipLowerKey = false;
-						break;
-					}
-				}
-
-				if ((q >= end) && (p < node.data + node.length) && skipLowerKey && partLower)
-				{
-					// since key length always is multiplier of (STUFF_COUNT + 1) (for partial
-					// compound keys) and we passed lower key completely then p pointed
-					// us to the next segment number and we can use this fact to calculate
-					// how many segments is equal to lower key
-					const USHORT segnum = idx.idx_count - (UCHAR) (descending ? ((*p) ^ -1) : *p);
-
-					if (segnum < retrieval->irb_lower_count)
-						skipLowerKey = false;
-				}
-			}
-			else
-				skipLowerKey = false;
-		}
-	}
-	else
-	{
-		pointer = page->btr_nodes + page->btr_jump_size;
-		prefix = 0;
-		skipLowerKey = false;
-	}
-
-	// if there is an upper bound, scan the index pages looking for it
-	if (retrieval->irb_upper_count)
-	{
-		while (scan(tdbb, pointer, bitmap, bitmap_and, &idx, retrieval, prefix, &upper,
-					skipLowerKey, lower))
-		{
-			page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-			pointer = page->btr_nodes + page->btr_jump_size;
-			prefix = 0;
-		}
-	}
-	else
-	{
-		// if there isn't an upper bound, just walk the index to the end of the level
-		const UCHAR* endPointer = (UCHAR*) page + page->btr_length;
-		const bool ignoreNulls =
-			(retrieval->irb_generic & irb_ignore_null_value_key) && (idx.idx_count == 1);
-
-		IndexNode node;
-		pointer = node.readNode(pointer, true);
-
-		// Check if pointer is still valid
-		if (pointer > endPointer)
-			BUGCHECK(204);	// msg 204 index inconsistent
-
-		while (true)
-		{
-			if (node.isEndLevel)
-				break;
-
-			if (!node.isEndBucket)
-			{
-				// If we're walking in a descending index and we need to ignore NULLs
-				// then stop at the first NULL we see (only for single segment!)
-				if (descending && ignoreNulls && node.prefix == 0 &&
-					node.length >= 1 && node.data[0] == 255)
-				{
-					break;
-				}
-
-				if (skipLowerKey)
-					checkForLowerKeySkip(skipLowerKey, partLower, node, lower, idx, retrieval);
-
-				if (!skipLowerKey)
-				{
-					if (!bitmap_and || bitmap_and->test(node.recordNumber.getValue()))
-						RBM_SET(tdbb->getDefaultPool(), bitmap, node.recordNumber.getValue());
-				}
-
-				pointer = node.readNode(pointer, true);
-
-				// Check if pointer is still valid
-				if (pointer > endPointer)
-					BUGCHECK(204);	// msg 204 index inconsistent
-
-				continue;
-			}
-
-			page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-			endPointer = (UCHAR*) page + page->btr_length;
-			pointer = page->btr_nodes + page->btr_jump_size;
-			pointer = node.readNode(pointer, true);
-
-			// Check if pointer is still valid
-			if (pointer > endPointer)
-				BUGCHECK(204);	// msg 204 index inconsistent
-		}
-	}
-
-	CCH_RELEASE(tdbb, &window);
+	evaluate_range(tdbb, retrieval, &window, page, idx, lower, upper, bitmap, bitmap_and);
 }
 
 
@@ -1000,6 +886,10 @@ void BTR_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 
 	index_desc* idx = insertion->iib_descriptor;
 	RelationPages* relPages = insertion->iib_relation->getPages(tdbb);
+
+	if (insert_last_leaf(tdbb, root_window, insertion, relPages))
+		return;
+
 	WIN window(relPages->rel_pg_space_id, idx->idx_root);
 	btree_page* bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_index);
 	UCHAR root_level = bucket->btr_level;
@@ -1504,7 +1394,8 @@ idx_e BTR_make_key(thread_db* tdbb,
 				   const ValueExprNode* const* exprs,
 				   const index_desc* idx,
 				   temporary_key* key,
-				   bool fuzzy)
+				   bool fuzzy,
+				   USHORT first)
 {
 /**************************************
  *
@@ -1515,6 +1406,9 @@ idx_e BTR_make_key(thread_db* tdbb,
  * Functional description
  *	Construct a (possibly) compound search key given a key count,
  *	a vector of value expressions, and a place to put the key.
+ *	If the first segment to process is not zero, only the part
+ *	of a compound key following the preceding segments is built
+ *	(and the expressions for the skipped segments are not used).
  *
  **************************************/
 	DSC temp_desc;
@@ -1529,6 +1423,7 @@ idx_e BTR_make_key(thread_db* tdbb,
 	fb_assert(idx != NULL);
 	fb_assert(exprs != NULL);
 	fb_assert(key != NULL);
+	fb_assert(first < count);
 
 	key->key_flags = 0;
 	key->key_nulls = 0;
@@ -1545,6 +1440,8 @@ idx_e BTR_make_key(thread_db* tdbb,
 	// If the index is a single segment index, don't sweat the compound stuff
 	if (idx->idx_count == 1)
 	{
+		fb_assert(first == 0);
+
 		bool isNull;
 		const dsc* desc = eval(tdbb, *exprs, &temp_desc, &isNull);
 		key->key_flags |= key_empty;
@@ -1564,7 +1461,9 @@ idx_e BTR_make_key(thread_db* tdbb,
 		SSHORT stuff_count = 0;
 		bool is_key_empty = true;
 		USHORT prior_length = 0;
-		USHORT n = 0;
+		USHORT n = first;
+		exprs += first;
+		tail += first;
 		for (; n < count; n++, tail++)
 		{
 			for (; stuff_count; --stuff_count)
@@ -1782,7 +1681,7 @@ bool BTR_next_index(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, in
 				irt_desc = root->irt_rpt + id;
 
 				if (irt_desc->getTransaction() == trans)
-					BTR_delete_index(tdbb, window, id);
+					BTR_delete_index(tdbb, window, id, relPages);
 				else
 					CCH_RELEASE(tdbb, window);
 
@@ -1803,6 +1702,143 @@ bool BTR_next_index(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, in
 }
 
 
+double BTR_range_selectivity(thread_db* tdbb, jrd_rel* relation, const index_desc* idx,
+							 const dsc* lowerValue, const dsc* upperValue)
+{
+/**************************************
+ *
+ *	B T R _ r a n g e _ s e l e c t i v i t y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the fraction of index keys whose leading segment
+ *	lies between the given values (either may be missing).
+ *	The nodes of the index root page split the index into
+ *	subtrees of a similar size, so they're used as an
+ *	equi-depth histogram. If the root is a leaf, the keys
+ *	are just counted. Return zero if there is no estimate.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	// Minimal number of subtrees to consider the histogram useful
+	const ULONG MIN_RANGE_BUCKETS = 16;
+
+	temporary_key lower, upper;
+	lower.key_length = upper.key_length = 0;
+
+	// Generate keys before we get any pages locked. A conversion error
+	// here is not ours to report, the query will raise it when executed.
+	try
+	{
+		ThreadStatusGuard temp_status(tdbb);
+
+		if (lowerValue)
+			make_leading_key(tdbb, idx, lowerValue, &lower);
+
+		if (upperValue)
+			make_leading_key(tdbb, idx, upperValue, &upper);
+	}
+	catch (const Exception&)
+	{
+		return 0;
+	}
+
+	// Descending keys are complemented, so the bounds swap
+	const bool descending = (idx->idx_flags & idx_descending);
+	const temporary_key* const lowerKey =
+		descending ? (upperValue ? &upper : NULL) : (lowerValue ? &lower : NULL);
+	const temporary_key* const upperKey =
+		descending ? (lowerValue ? &lower : NULL) : (upperValue ? &upper : NULL);
+
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	index_root_page* root = fetch_root(tdbb, &window, relation, relPages);
+	if (!root)
+		return 0;
+
+	ULONG page;
+	if (idx->idx_id >= root->irt_count || !(page = root->irt_rpt[idx->idx_id].getRoot()))
+	{
+		CCH_RELEASE(tdbb, &window);
+		return 0;
+	}
+
+	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
+	const bool leafPage = (bucket->btr_level == 0);
+	const UCHAR* const endPointer = (UCHAR*) bucket + bucket->btr_length;
+
+	// Count the nodes below the lower key and those not above the upper key
+
+	UCHAR keyData[MAX_KEY];
+	ULONG total = 0, below = 0, notAbove = 0;
+
+	IndexNode node;
+	UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
+
+	while (true)
+	{
+		pointer = node.readNode(pointer, leafPage);
+
+		if (pointer > endPointer)
+			BUGCHECK(204);	// msg 204 index inconsistent
+
+		if (node.isEndLevel || node.isEndBucket)
+			break;
+
+		memcpy(keyData + node.prefix, node.data, node.length);
+		const USHORT keyLength = node.prefix + node.length;
+		total++;
+
+		if (lowerKey)
+		{
+			const int result = memcmp(keyData, lowerKey->key_data,
+									  MIN(keyLength, lowerKey->key_length));
+
+			if (result < 0 || (result == 0 && keyLength < lowerKey->key_length))
+			{
+				below++;
+				notAbove++;
+				continue;
+			}
+		}
+
+		if (upperKey)
+		{
+			const int result = memcmp(keyData, upperKey->key_data,
+									  MIN(keyLength, upperKey->key_length));
+
+			// The upper key is a partial one, so the keys it prefixes are not above it
+			if (result > 0)
+				break;
+		}
+
+		notAbove++;
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	if (!total)
+		return 0;
+
+	if (leafPage)
+		return (double) MAX(notAbove - below, 1) / total;
+
+	if (total < MIN_RANGE_BUCKETS)
+		return 0;
+
+	// Every node of an upper level page starts a subtree, thus the bounds
+	// belong to the subtrees started by the last nodes below them. Assume
+	// that they split their subtrees in halves.
+	const double lowerPosition = lowerKey ? below - 0.5 : 0;
+	const double upperPosition = upperKey ? notAbove - 0.5 : total;
+
+	return MAX(upperPosition - lowerPosition, 0.5) / total;
+}
+
+
 void BTR_remove(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 {
 /**************************************
@@ -1878,6 +1914,8 @@ void BTR_remove(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 
 		CCH_RELEASE(tdbb, &window);
 		PAG_release_page(tdbb, window.win_page, root_window->win_page);
+
+		relPages->invalidateLeafHints();
 	}
 
 	if (window.win_bdb)
@@ -2014,7 +2052,8 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 }
 
 
-void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+FB_UINT64 BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity,
+						   ULONG sample)
 {
 /**************************************
  *
@@ -2029,6 +2068,13 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
  *	effects of uncommitted transactions
  *	will be included in the calculation.
  *
+ *	If sample is not zero and the index has
+ *	more leaf pages than that, only as many
+ *	evenly spaced leaf pages are read and
+ *	the counts are extrapolated.
+ *
+ *	Returns the (estimated) number of nodes.
+ *
  **************************************/
 
 	SET_TDBB(tdbb);
@@ -2037,13 +2083,13 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	index_root_page* root = fetch_root(tdbb, &window, relation, relPages);
 	if (!root)
-		return;
+		return 0;
 
 	ULONG page;
 	if (id >= root->irt_count || !(page = root->irt_rpt[id].getRoot()))
 	{
 		CCH_RELEASE(tdbb, &window);
-		return;
+		return 0;
 	}
 
 	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
@@ -2053,17 +2099,65 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 	window.win_scans = 1;
 	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
 
+	// When sampling, the leaf page numbers are taken from the level above
+	// the leaves, then only every n-th of them is visited
+	HalfStaticArray<ULONG, 64> samples;
+	ULONG leafCount = 0;
+
 	// go down the left side of the index to leaf level
 	UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
 	while (bucket->btr_level)
 	{
 		IndexNode pageNode;
 		pageNode.readNode(pointer, false);
+
+		if (sample && bucket->btr_level == 1)
+		{
+			HalfStaticArray<ULONG, 64> leafPages;
+			IndexNode node;
+			UCHAR* p = pointer;
+
+			while (true)
+			{
+				p = node.readNode(p, false);
+
+				if (node.isEndLevel)
+					break;
+
+				if (node.isEndBucket)
+				{
+					bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, bucket->btr_sibling,
+						LCK_read, pag_index);
+					p = bucket->btr_nodes + bucket->btr_jump_size;
+					continue;
+				}
+
+				leafPages.add(node.pageNumber);
+
+				if ((leafPages.getCount() % 100 == 0) && (--tdbb->tdbb_quantum < 0))
+					JRD_reschedule(tdbb, 0, true);
+			}
+
+			if (leafPages.getCount() > sample)
+			{
+				leafCount = leafPages.getCount();
+				for (ULONG i = 0; i < sample; i++)
+					samples.add(leafPages[(FB_SIZE_T) ((FB_UINT64) i * leafCount / sample)]);
+			}
+		}
+
+		// The leftmost page of a level is never released by the index
+		// garbage collection, so it is safe to go there from anywhere
 		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
 		pointer = bucket->btr_nodes + bucket->btr_jump_size;
 		page = pageNode.pageNumber;
 	}
 
+	FB_SIZE_T sampleNo = 0;
+	ULONG visited = 1;
+	if (samples.hasData())
+		CCH_read_ahead(tdbb, relPages->rel_pg_space_id, samples.begin(), (USHORT) samples.getCount());
+
 	FB_UINT64 nodes = 0;
 	FB_UINT64 duplicates = 0;
 	temporary_key key;
@@ -2077,6 +2171,17 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 	duplicatesList.grow(segments);
 	memset(duplicatesList.begin(), 0, segments * sizeof(FB_UINT64));
 
+	// When sampling, the first node of a sampled page is compared with the
+	// last node of the previously sampled one. These comparisons stand for
+	// the pages skipped in between, so they are counted apart and are not
+	// extrapolated.
+	bool edgeNode = false;
+	FB_UINT64 edgeNodes = 0;
+	FB_UINT64 edgeDuplicates = 0;
+	HalfStaticArray<FB_UINT64, 4> edgeDuplicatesList;
+	edgeDuplicatesList.grow(segments);
+	memset(edgeDuplicatesList.begin(), 0, segments * sizeof(FB_UINT64));
+
 	//const Database* dbb = tdbb->getDatabase();
 
 	// go through all the leaf nodes and count them;
@@ -2171,7 +2276,12 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 					count = 0; // All segments are duplicates
 
 				for (ULONG i = count + 1; i <= segments; i++)
+				{
 					duplicatesList[segments - i]++;
+
+					if (edgeNode)
+						edgeDuplicatesList[segments - i]++;
+				}
 			}
 
 			// figure out if this is a duplicate
@@ -2187,30 +2297,87 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 			if (firstNode)
 				firstNode = false;
 
+			if (edgeNode)
+			{
+				++edgeNodes;
+
+				if (dup)
+					++edgeDuplicates;
+
+				edgeNode = false;
+			}
+
 			// keep the key value current for comparison with the next key
 			key.key_length = l;
 			memcpy(key.key_data + node.prefix, node.data, node.length);
 			pointer = node.readNode(pointer, true);
 		}
 
-		if (node.isEndLevel || !(page = bucket->btr_sibling))
-			break;
+		if (samples.hasData())
+		{
+			// Move to the next sampled leaf. Skip pages released or reused
+			// since the level above them was read. The last key is kept, as
+			// the index is ordered, its first key being equal means all the
+			// keys in between are equal too.
+
+			CCH_RELEASE_TAIL(tdbb, &window);
+			bucket = NULL;
+
+			while (!bucket && ++sampleNo < samples.getCount())
+			{
+				window.win_page = samples[sampleNo];
+				bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+				if (bucket->btr_header.pag_type != pag_index || bucket->btr_level ||
+					bucket->btr_id != (UCHAR)(id % 256) || bucket->btr_relation != relation->rel_id)
+				{
+					CCH_RELEASE_TAIL(tdbb, &window);
+					bucket = NULL;
+				}
+			}
+
+			if (!bucket)
+				break;
+
+			++visited;
+			edgeNode = true;
+		}
+		else
+		{
+			if (node.isEndLevel || !(page = bucket->btr_sibling))
+				break;
+
+			bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
+		}
 
-		bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
 		pointer = bucket->btr_nodes + bucket->btr_jump_size;
 	}
 
-	CCH_RELEASE_TAIL(tdbb, &window);
+	if (bucket)
+		CCH_RELEASE_TAIL(tdbb, &window);
+
+	// extrapolate the sampled counts to the whole leaf level
+	const double scale = samples.hasData() ? (double) leafCount / visited : 1.0;
 
 	// calculate the selectivity
 	selectivity.grow(segments);
 	if (segments > 1)
 	{
 		for (ULONG i = 0; i < segments; i++)
-			selectivity[i] = (float) (nodes ? 1.0 / (float) (nodes - duplicatesList[i]) : 0.0);
+		{
+			const double distinct =
+				(double) ((nodes - edgeNodes) - (duplicatesList[i] - edgeDuplicatesList[i])) * scale +
+				(double) (edgeNodes - edgeDuplicatesList[i]);
+			selectivity[i] = (float) (distinct > 0 ? 1.0 / distinct : 0.0);
+		}
 	}
 	else
-		selectivity[0] = (float) (nodes ? 1.0 / (float) (nodes - duplicates) : 0.0);
+	{
+		const double distinct =
+			(double) ((nodes - edgeNodes) - (duplicates - edgeDuplicates)) * scale +
+			(double) (edgeNodes - edgeDuplicates);
+		selectivity[0] = (float) (distinct > 0 ? 1.0 / distinct : 0.0);
+	}
 
 	// Store the selectivity on the root page
 	window.win_page = relPages->rel_index_root;
@@ -2219,6 +2386,8 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 	CCH_MARK(tdbb, &window);
 	update_selectivity(root, id, selectivity);
 	CCH_RELEASE(tdbb, &window);
+
+	return (FB_UINT64) (nodes * scale);
 }
 
 
@@ -2295,8 +2464,22 @@ static ULONG add_node(thread_db* tdbb,
 	{
 		while (true)
 		{
+			const ULONG page = window->win_page.getPageNum();
+			bool insertedLast = false;
 			const ULONG split = insert_node(tdbb, window, insertion, new_key,
-				new_record_number, original_page, sibling_page);
+				new_record_number, original_page, sibling_page, true, &insertedLast);
+
+			// remember the leaf only if the key went to its end, as the next one may
+			if (split == NO_SPLIT && !insertion->iib_btr_level)
+			{
+				const index_desc* const idx = insertion->iib_descriptor;
+				RelationPages* const relPages = insertion->iib_relation->getPages(tdbb);
+
+				if (insertedLast)
+					relPages->setLeafHint(idx->idx_id, idx->idx_root, page);
+				else
+					relPages->clearLeafHint(idx->idx_id);
+			}
 
 			if (split != NO_VALUE_PAGE)
 				return split;
@@ -2397,6 +2580,40 @@ static ULONG add_node(thread_db* tdbb,
 }
 
 
+static inline USHORT common_prefix(const UCHAR* p, const UCHAR* q, USHORT length)
+{
+/**************************************
+ *
+ *	c o m m o n _ p r e f i x
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the number of leading bytes two strings
+ *	of the given length have in common. Compare a
+ *	machine word at a time and locate the differing
+ *	byte inside the last word only.
+ *
+ **************************************/
+	USHORT n = 0;
+
+	for (; n + sizeof(FB_UINT64) <= length; n += sizeof(FB_UINT64))
+	{
+		FB_UINT64 a, b;
+		memcpy(&a, p + n, sizeof(a));
+		memcpy(&b, q + n, sizeof(b));
+
+		if (a != b)
+			break;
+	}
+
+	while (n < length && p[n] == q[n])
+		n++;
+
+	return n;
+}
+
+
 static void compress(thread_db* tdbb,
 					 const dsc* desc,
 					 temporary_key* key,
@@ -3207,53 +3424,210 @@ static void delete_tree(thread_db* tdbb,
 				down = 0;
 		}
 
-		// go through all the sibling pages on this level and release them
-		next = page->btr_sibling;
-		CCH_RELEASE_TAIL(tdbb, &window);
-		PAG_release_page(tdbb, window.win_page, prior);
-		prior = window.win_page;
+		// go through all the sibling pages on this level and release them
+		next = page->btr_sibling;
+		CCH_RELEASE_TAIL(tdbb, &window);
+		PAG_release_page(tdbb, window.win_page, prior);
+		prior = window.win_page;
+
+		// if we are at end of level, go down to the next level
+		if (!next.getPageNum())
+			next = down;
+	}
+}
+
+
+static DSC* eval(thread_db* tdbb, const ValueExprNode* node, DSC* temp, bool* isNull)
+{
+/**************************************
+ *
+ *	e v a l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Evaluate an expression returning a descriptor, and
+ *	a flag to indicate a null value.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	jrd_req* request = tdbb->getRequest();
+
+	dsc* desc = EVL_expr(tdbb, request, node);
+	*isNull = false;
+
+	if (desc && !(request->req_flags & req_null))
+		return desc;
+
+	*isNull = true;
+
+	temp->dsc_dtype = dtype_text;
+	temp->dsc_flags = 0;
+	temp->dsc_sub_type = 0;
+	temp->dsc_scale = 0;
+	temp->dsc_length = 1;
+	temp->dsc_ttype() = ttype_ascii;
+	temp->dsc_address = (UCHAR*) " ";
+
+	return temp;
+}
+
+
+static void evaluate_range(thread_db* tdbb, const IndexRetrieval* retrieval, WIN* window,
+						   btree_page* page, index_desc& idx, temporary_key& lower,
+						   temporary_key& upper, RecordBitmap** bitmap, RecordBitmap* bitmap_and)
+{
+/**************************************
+ *
+ *	e v a l u a t e _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Scan the leaf level between the given lower and upper keys,
+ *	starting at the leaf page found by BTR_find_page, and set
+ *	the matching record numbers in the bitmap. The window is
+ *	released on return.
+ *
+ **************************************/
+
+	const bool descending = (idx.idx_flags & idx_descending);
+	bool skipLowerKey = (retrieval->irb_generic & irb_exclude_lower);
+	const bool partLower = (retrieval->irb_lower_count < idx.idx_count);
+
+	// If there is a starting descriptor, search down index to starting position.
+	// This may involve sibling buckets if splits are in progress.  If there
+	// isn't a starting descriptor, walk down the left side of the index.
+	USHORT prefix;
+	UCHAR* pointer;
+	if (retrieval->irb_lower_count)
+	{
+		while (!(pointer = find_node_start_point(page, &lower, 0, &prefix,
+			idx.idx_flags & idx_descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
+		{
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+		}
+
+		// Compute the number of matching characters in lower and upper bounds
+		if (retrieval->irb_upper_count)
+		{
+			prefix = IndexNode::computePrefix(upper.key_data, upper.key_length,
+											  lower.key_data, lower.key_length);
+		}
+
+		if (skipLowerKey)
+		{
+			IndexNode node;
+			node.readNode(pointer, true);
+
+			if ((lower.key_length == node.prefix + node.length) ||
+				(lower.key_length <= node.prefix + node.length) && partLower)
+			{
+				const UCHAR* p = node.data, *q = lower.key_data + node.prefix;
+				const UCHAR* const end = lower.key_data + lower.key_length;
+				while (q < end)
+				{
+					if (*p++ != *q++)
+					{
+						skipLowerKey = false;
+						break;
+					}
+				}
+
+				if ((q >= end) && (p < node.data + node.length) && skipLowerKey && partLower)
+				{
+					// since key length always is multiplier of (STUFF_COUNT + 1) (for partial
+					// compound keys) and we passed lower key completely then p pointed
+					// us to the next segment number and we can use this fact to calculate
+					// how many segments is equal to lower key
+					const USHORT segnum = idx.idx_count - (UCHAR) (descending ? ((*p) ^ -1) : *p);
+
+					if (segnum < retrieval->irb_lower_count)
+						skipLowerKey = false;
+				}
+			}
+			else
+				skipLowerKey = false;
+		}
+	}
+	else
+	{
+		pointer = page->btr_nodes + page->btr_jump_size;
+		prefix = 0;
+		skipLowerKey = false;
+	}
+
+	// if there is an upper bound, scan the index pages looking for it
+	if (retrieval->irb_upper_count)
+	{
+		while (scan(tdbb, pointer, bitmap, bitmap_and, &idx, retrieval, prefix, &upper,
+					skipLowerKey, lower))
+		{
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+			pointer = page->btr_nodes + page->btr_jump_size;
+			prefix = 0;
+		}
+	}
+	else
+	{
+		// if there isn't an upper bound, just walk the index to the end of the level
+		const UCHAR* endPointer = (UCHAR*) page + page->btr_length;
+		const bool ignoreNulls =
+			(retrieval->irb_generic & irb_ignore_null_value_key) && (idx.idx_count == 1);
+
+		IndexNode node;
+		pointer = node.readNode(pointer, true);
 
-		// if we are at end of level, go down to the next level
-		if (!next.getPageNum())
-			next = down;
-	}
-}
+		// Check if pointer is still valid
+		if (pointer > endPointer)
+			BUGCHECK(204);	// msg 204 index inconsistent
 
+		while (true)
+		{
+			if (node.isEndLevel)
+				break;
 
-static DSC* eval(thread_db* tdbb, const ValueExprNode* node, DSC* temp, bool* isNull)
-{
-/**************************************
- *
- *	e v a l
- *
- **************************************
- *
- * Functional description
- *	Evaluate an expression returning a descriptor, and
- *	a flag to indicate a null value.
- *
- **************************************/
-	SET_TDBB(tdbb);
+			if (!node.isEndBucket)
+			{
+				// If we're walking in a descending index and we need to ignore NULLs
+				// then stop at the first NULL we see (only for single segment!)
+				if (descending && ignoreNulls && node.prefix == 0 &&
+					node.length >= 1 && node.data[0] == 255)
+				{
+					break;
+				}
 
-	jrd_req* request = tdbb->getRequest();
+				if (skipLowerKey)
+					checkForLowerKeySkip(skipLowerKey, partLower, node, lower, idx, retrieval);
 
-	dsc* desc = EVL_expr(tdbb, request, node);
-	*isNull = false;
+				if (!skipLowerKey)
+				{
+					if (!bitmap_and || bitmap_and->test(node.recordNumber.getValue()))
+						RBM_SET(tdbb->getDefaultPool(), bitmap, node.recordNumber.getValue());
+				}
 
-	if (desc && !(request->req_flags & req_null))
-		return desc;
+				pointer = node.readNode(pointer, true);
 
-	*isNull = true;
+				// Check if pointer is still valid
+				if (pointer > endPointer)
+					BUGCHECK(204);	// msg 204 index inconsistent
 
-	temp->dsc_dtype = dtype_text;
-	temp->dsc_flags = 0;
-	temp->dsc_sub_type = 0;
-	temp->dsc_scale = 0;
-	temp->dsc_length = 1;
-	temp->dsc_ttype() = ttype_ascii;
-	temp->dsc_address = (UCHAR*) " ";
+				continue;
+			}
 
-	return temp;
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+			endPointer = (UCHAR*) page + page->btr_length;
+			pointer = page->btr_nodes + page->btr_jump_size;
+			pointer = node.readNode(pointer, true);
+
+			// Check if pointer is still valid
+			if (pointer > endPointer)
+				BUGCHECK(204);	// msg 204 index inconsistent
+		}
+	}
+
+	CCH_RELEASE(tdbb, window);
 }
 
 
@@ -4129,6 +4503,10 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 			const UCHAR* const nodeEnd = q + node.length;
 			if (descending)
 			{
+				const USHORT same = common_prefix(p, q, MIN(key_end - p, nodeEnd - q));
+				p += same;
+				q += same;
+
 				while (true)
 				{
 					if (q == nodeEnd || (retrieval && p == key_end))
@@ -4144,6 +4522,11 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 			else if (node.length > 0 || firstPass)
 			{
 				firstPass = false;
+
+				const USHORT same = common_prefix(p, q, MIN(key_end - p, nodeEnd - q));
+				p += same;
+				q += same;
+
 				while (true)
 				{
 					if (p == key_end)
@@ -4251,6 +4634,10 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 
 		if ((jumpNode.prefix <= testPrefix) && descending)
 		{
+			const USHORT same = common_prefix(keyPointer, q, MIN(keyEnd - keyPointer, nodeEnd - q));
+			keyPointer += same;
+			q += same;
+
 			while (true)
 			{
 				if (q == nodeEnd)
@@ -4320,6 +4707,10 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 		}
 		else if (jumpNode.prefix <= testPrefix)
 		{
+			const USHORT same = common_prefix(keyPointer, q, MIN(keyEnd - keyPointer, nodeEnd - q));
+			keyPointer += same;
+			q += same;
+
 			while (true)
 			{
 				if (keyPointer == keyEnd)
@@ -4503,6 +4894,10 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 			if (descending)
 			{
 				// Descending indexes
+				const USHORT same = common_prefix(p, q, MIN(keyEnd - p, nodeEnd - q));
+				p += same;
+				q += same;
+
 				while (true)
 				{
 					// Check for exact match and if we need to do
@@ -4532,6 +4927,10 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 			{
 				firstPass = false;
 				// Ascending index
+				const USHORT same = common_prefix(p, q, MIN(keyEnd - p, nodeEnd - q));
+				p += same;
+				q += same;
+
 				while (true)
 				{
 					if (p == keyEnd)
@@ -5230,13 +5629,119 @@ static void generate_jump_nodes(thread_db* tdbb, btree_page* page,
 }
 
 
+static bool insert_last_leaf(thread_db* tdbb,
+							 WIN* root_window,
+							 index_insertion* insertion,
+							 RelationPages* relPages)
+{
+/**************************************
+ *
+ *	i n s e r t _ l a s t _ l e a f
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to insert a node straight into the leaf page
+ *	which took the previous key of the index at its end,
+ *	without descending from the top of the tree. This
+ *	pays off when keys arrive in order, as in a bulk load.
+ *	Return false with nothing changed if the key doesn't
+ *	belong to that page or the page would have to split.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+
+	const index_desc* const idx = insertion->iib_descriptor;
+	const temporary_key* const key = insertion->iib_key;
+	const jrd_rel* const relation = insertion->iib_relation;
+
+	if (insertion->iib_btr_level || (idx->idx_flags & idx_descending))
+		return false;
+
+	// Unless the database is shared by every attachment, an index may be
+	// dropped by another process without the count of deleted trees changing
+	if (!(dbb->dbb_flags & DBB_shared) && !(relation->rel_flags & (REL_temp_tran | REL_temp_conn)))
+		return false;
+
+	relPages->syncLeafHints((ULONG) dbb->dbb_index_drops.value());
+
+	const ULONG leaf = relPages->getLeafHint(idx->idx_id, idx->idx_root);
+
+	if (!leaf)
+		return false;
+
+	// Don't wait for the page, the regular descent will do
+
+	WIN window(relPages->rel_pg_space_id, leaf);
+	btree_page* const bucket =
+		(btree_page*) CCH_FETCH_TIMEOUT(tdbb, &window, LCK_write, pag_undefined, 0);
+
+	if (!bucket)
+		return false;
+
+	// A page merged by garbage collection is marked released before the hints
+	// are voided, and a page of another index or relation may be found after
+	// a hint was taken
+
+	bool usable = (bucket->btr_header.pag_type == pag_index) &&
+		!(bucket->btr_header.pag_flags & btr_released) &&
+		bucket->btr_relation == relation->rel_id &&
+		bucket->btr_id == (UCHAR) (idx->idx_id % 256) && bucket->btr_level == 0;
+
+	// Keys up to the first one of the page may belong to its left sibling
+
+	if (usable && bucket->btr_left_sibling)
+	{
+		IndexNode node;
+		node.readNode(bucket->btr_nodes + bucket->btr_jump_size, true);
+		fb_assert(node.prefix == 0);
+
+		if (node.isEndBucket || node.isEndLevel)
+			usable = false;
+		else
+		{
+			const int result = memcmp(key->key_data, node.data, MIN(key->key_length, node.length));
+			usable = (result > 0 || (result == 0 && key->key_length > node.length));
+		}
+	}
+
+	if (usable)
+	{
+		temporary_key new_key;
+		new_key.key_flags = 0;
+		new_key.key_length = 0;
+		RecordNumber new_record_number(0);
+		bool insertedLast = false;
+
+		if (insert_node(tdbb, &window, insertion, &new_key, &new_record_number,
+				NULL, NULL, false, &insertedLast) == NO_SPLIT)
+		{
+			if (!insertedLast)
+				relPages->clearLeafHint(idx->idx_id);
+
+			CCH_RELEASE(tdbb, root_window);
+			return true;
+		}
+	}
+
+	// Don't try the page again before another key lands at its end
+	relPages->clearLeafHint(idx->idx_id);
+
+	CCH_RELEASE(tdbb, &window);
+	return false;
+}
+
+
 static ULONG insert_node(thread_db* tdbb,
 						 WIN* window,
 						 index_insertion* insertion,
 						 temporary_key* new_key,
 						 RecordNumber* new_record_number,
 						 ULONG* original_page,
-						 ULONG* sibling_page)
+						 ULONG* sibling_page,
+						 bool allowSplit,
+						 bool* insertedLast)
 {
 /**************************************
  *
@@ -5249,6 +5754,9 @@ static ULONG insert_node(thread_db* tdbb,
  *  If this isn't the right bucket, return NO_VALUE.
  *  If it splits, return the split page number and
  *	leading string.  This is the workhorse for add_node.
+ *  If the split is not allowed, return NO_VALUE instead
+ *	and leave the page unchanged. If asked, tell whether
+ *	the node was inserted at the end of the page.
  *
  **************************************/
 
@@ -5422,6 +5930,9 @@ static ULONG insert_node(thread_db* tdbb,
 	// figure out whether this node was inserted at the end of the page
 	const bool endOfPage = (beforeInsertNode.isEndBucket || beforeInsertNode.isEndLevel);
 
+	if (insertedLast)
+		*insertedLast = endOfPage;
+
 	// Initialize variables needed for generating jump information
 	bool fragmentedOffset = false;
 	USHORT newPrefixTotalBySplit = 0;
@@ -5556,6 +6067,20 @@ static ULONG insert_node(thread_db* tdbb,
 		return NO_SPLIT;
 	}
 
+	if (!allowSplit)
+	{
+		if (fragmentedOffset)
+		{
+			IndexJumpNode* walkJumpNode = jumpNodes->begin();
+			for (size_t i = 0; i < jumpNodes->getCount(); i++)
+				delete[] walkJumpNode[i].data;
+		}
+
+		jumpNodes->clear();
+
+		return NO_VALUE_PAGE;
+	}
+
 	// We've a bucket split in progress.  We need to determine the split point.
 	// Set it halfway through the page, unless we are at the end of the page,
 	// in which case put only the new node on the new page.  This will ensure
@@ -5765,6 +6290,10 @@ static ULONG insert_node(thread_db* tdbb,
 	// mark the end of the page; note that the end_bucket marker must
 	// contain info about the first node on the next page. So we don't
 	// overwrite the existing data.
+	// Both the marker and the key propagated to the parent are full copies
+	// of that key. Truncating them to the distinguishing prefix would put
+	// keys on disk that the validation and the unique NULL-key check don't
+	// expect, so it needs an ODS flag telling such trees apart first.
 	node.setEndBucket();
 	pointer = node.writeNode(node.nodePointer, leafPage, false);
 	newBucket->btr_length = pointer - (UCHAR*) newBucket;
@@ -5902,6 +6431,61 @@ static INT64_KEY make_int64_key(SINT64 q, SSHORT scale)
 }
 
 
+static void make_leading_key(thread_db* tdbb, const index_desc* idx, const dsc* desc,
+							 temporary_key* key)
+{
+/**************************************
+ *
+ *	m a k e _ l e a d i n g _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Construct a partial search key given a value
+ *	of the leading index segment.
+ *
+ **************************************/
+	const bool descending = (idx->idx_flags & idx_descending);
+	const USHORT keyType = (idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+
+	key->key_flags = key_empty;
+	key->key_nulls = 0;
+
+	if (idx->idx_count == 1)
+		compress(tdbb, desc, key, idx->idx_rpt[0].idx_itype, false, descending, keyType);
+	else
+	{
+		temporary_key temp;
+		temp.key_flags = key_empty;
+		temp.key_length = 0;
+
+		compress(tdbb, desc, &temp, idx->idx_rpt[0].idx_itype, false, descending, keyType);
+
+		UCHAR* p = key->key_data;
+		const UCHAR* const end = key->key_data + MAX_KEY;
+		const UCHAR* q = temp.key_data;
+
+		for (USHORT l = 0; l < temp.key_length && p < end; l++)
+		{
+			if (l % STUFF_COUNT == 0)
+			{
+				*p++ = idx->idx_count;
+
+				if (p >= end)
+					break;
+			}
+
+			*p++ = *q++;
+		}
+
+		key->key_length = p - key->key_data;
+	}
+
+	if (descending)
+		BTR_complement_key(key);
+}
+
+
 #ifdef DEBUG_INDEXKEY
 static void print_int64_key(SINT64 value, SSHORT scale, INT64_KEY key)
 {
@@ -6048,7 +6632,11 @@ static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* wi
 			const contents result = remove_node(tdbb, insertion, window);
 
 			if (result != contents_above_threshold)
+			{
+				// the page may be released, so forget where the last keys went
+				insertion->iib_relation->getPages(tdbb)->invalidateLeafHints();
 				return garbage_collect(tdbb, window, parent_number);
+			}
 
 			if (window->win_bdb)
 				CCH_RELEASE(tdbb, window);
@@ -6259,7 +6847,7 @@ static bool scan(thread_db* tdbb, UCHAR* pointer, RecordBitmap** bitmap, RecordB
 
 	// reset irb_equality flag passed for optimization
 	flag &= ~(irb_equality | irb_ignore_null_value_key);
-	flag &= ~(irb_exclude_lower | irb_exclude_upper);
+	flag &= ~(irb_exclude_lower | irb_exclude_upper | irb_skip_scan);
 
 	IndexNode node;
 	pointer = node.readNode(pointer, true);
@@ -6401,6 +6989,143 @@ static bool scan(thread_db* tdbb, UCHAR* pointer, RecordBitmap** bitmap, RecordB
 	return false;	// superfluous return to shut lint up
 }
 
+static void skip_scan(thread_db* tdbb, const IndexRetrieval* retrieval,
+					  RecordBitmap** bitmap, RecordBitmap* bitmap_and)
+{
+/**************************************
+ *
+ *	s k i p _ s c a n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Do an index scan which skips the leading segment of
+ *	a compound index. For every distinct value of the leading
+ *	segment found in the index, the remaining segments are
+ *	scanned as if the leading one was matched for equality.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	const index_desc* const desc = &retrieval->irb_desc;
+
+	fb_assert(desc->idx_count > 1 && !(desc->idx_flags & idx_descending));
+	fb_assert(retrieval->irb_lower_count && retrieval->irb_upper_count);
+
+	// Generate the key parts following the leading segment before we get
+	// any pages locked, they're the same for every leading value
+
+	temporary_key lowerTail, upperTail;
+	lowerTail.key_flags = upperTail.key_flags = 0;
+	lowerTail.key_length = upperTail.key_length = 0;
+	lowerTail.key_nulls = upperTail.key_nulls = 0;
+
+	const bool fuzzy = (retrieval->irb_generic & irb_starting) != 0;
+	idx_e errorCode = idx_e_ok;
+
+	if (retrieval->irb_upper_count > 1)
+	{
+		errorCode = BTR_make_key(tdbb, retrieval->irb_upper_count,
+								 retrieval->irb_value + desc->idx_count,
+								 desc, &upperTail, fuzzy, 1);
+	}
+
+	if (errorCode == idx_e_ok && retrieval->irb_lower_count > 1)
+	{
+		errorCode = BTR_make_key(tdbb, retrieval->irb_lower_count,
+								 retrieval->irb_value, desc, &lowerTail, fuzzy, 1);
+	}
+
+	const USHORT maxKeyLength = tdbb->getDatabase()->getMaxIndexKeyLength();
+	RelationPages* const relPages = retrieval->irb_relation->getPages(tdbb);
+
+	temporary_key next, leading, lower, upper, temp;
+	next.key_flags = 0;
+	next.key_length = 0;
+	next.key_nulls = 0;
+
+	IndexRetrieval probe(retrieval->irb_relation, desc, 1, &next);
+
+	while (errorCode == idx_e_ok)
+	{
+		// Find the first key whose leading segment is not less than the one
+		// we're looking for, this is the next distinct leading value
+
+		WIN window(relPages->rel_pg_space_id, -1);
+		index_desc idx;
+
+		probe.irb_key = &next;
+		probe.irb_generic = 0;
+		btree_page* page = BTR_find_page(tdbb, &probe, &window, &idx, &temp, &temp);
+
+		UCHAR* pointer;
+		while (!(pointer = find_node_start_point(page, &next, leading.key_data, NULL, false, false)))
+			page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+
+		IndexNode node;
+		node.readNode(pointer, true);
+
+		if (node.isEndLevel)
+		{
+			CCH_RELEASE(tdbb, &window);
+			break;
+		}
+
+		// The leading segment is stored as a sequence of complete groups
+		// marked with the segment number, as another segment always follows
+
+		const USHORT keyLength = node.prefix + node.length;
+		USHORT length = 0;
+
+		while (length < keyLength && leading.key_data[length] == desc->idx_count)
+			length += STUFF_COUNT + 1;
+
+		leading.key_length = MIN(length, keyLength);
+
+		CCH_RELEASE(tdbb, &window);
+
+		if (leading.key_length + MAX(lowerTail.key_length, upperTail.key_length) >= maxKeyLength)
+		{
+			errorCode = idx_e_keytoobig;
+			break;
+		}
+
+		// Make the range keys for this leading value and scan the range
+
+		memcpy(lower.key_data, leading.key_data, leading.key_length);
+		memcpy(lower.key_data + leading.key_length, lowerTail.key_data, lowerTail.key_length);
+		lower.key_length = leading.key_length + lowerTail.key_length;
+		lower.key_flags = leading.key_length ? 0 : lowerTail.key_flags;
+		lower.key_nulls = lowerTail.key_nulls;
+
+		memcpy(upper.key_data, leading.key_data, leading.key_length);
+		memcpy(upper.key_data + leading.key_length, upperTail.key_data, upperTail.key_length);
+		upper.key_length = leading.key_length + upperTail.key_length;
+		upper.key_flags = leading.key_length ? 0 : upperTail.key_flags;
+		upper.key_nulls = upperTail.key_nulls;
+
+		probe.irb_key = &lower;
+		probe.irb_generic = retrieval->irb_generic & (irb_starting | irb_partial);
+		page = BTR_find_page(tdbb, &probe, &window, &idx, &temp, &temp);
+
+		evaluate_range(tdbb, retrieval, &window, page, idx, lower, upper, bitmap, bitmap_and);
+
+		// Any key greater than the current leading value is not less than
+		// the leading value followed by the marker of the leading segment
+
+		memcpy(next.key_data, leading.key_data, leading.key_length);
+		next.key_data[leading.key_length] = (UCHAR) desc->idx_count;
+		next.key_length = leading.key_length + 1;
+	}
+
+	if (errorCode != idx_e_ok)
+	{
+		index_desc temp_idx = *desc; // to avoid constness issues
+		IndexErrorContext context(retrieval->irb_relation, &temp_idx);
+		context.raise(tdbb, errorCode, NULL);
+	}
+}
+
 
 void update_selectivity(index_root_page* root, USHORT id, const SelectivityList& selectivity)
 {
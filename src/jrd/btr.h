@@ -67,6 +67,7 @@ struct index_desc
 	ValueExprNode* idx_expression;			// node tree for indexed expresssion
 	dsc		idx_expression_desc;			// descriptor for expression result
 	JrdStatement* idx_expression_statement;	// stored statement for expression evaluation
+	Firebird::SortedArray<USHORT>* idx_expression_fields;	// fields the expression depends on, if known
 	// This structure should exactly match IRTD structure for current ODS
 	struct idx_repeat
 	{
@@ -225,6 +226,7 @@ const int irb_ignore_null_value_key  = 8;	// if lower bound is specified and upp
 const int irb_descending	= 16;			// Base index uses descending order
 const int irb_exclude_lower	= 32;			// exclude lower bound keys while scanning index
 const int irb_exclude_upper	= 64;			// exclude upper bound keys while scanning index
+const int irb_skip_scan		= 128;			// Skip the leading segment, scanning per its distinct values
 
 typedef Firebird::HalfStaticArray<float, 4> SelectivityList;
 
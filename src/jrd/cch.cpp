@@ -1446,6 +1446,25 @@ void CCH_init2(thread_db* tdbb)
 
 		bcb->bcb_writer_init.enter();
 	}
+
+	if (!(att->att_flags & ATT_security_db) &&
+		!(bcb->bcb_flags & (BCB_cache_prefetcher | BCB_prefetcher_start)))
+	{
+		// prefetcher startup in progress
+		bcb->bcb_flags |= BCB_prefetcher_start;
+
+		try
+		{
+			bcb->bcb_prefetcher_fini.run(bcb);
+		}
+		catch (const Exception&)
+		{
+			bcb->bcb_flags &= ~BCB_prefetcher_start;
+			ERR_bugcheck_msg("cannot start cache prefetcher thread");
+		}
+
+		bcb->bcb_prefetcher_init.enter();
+	}
 }
 
 
@@ -1790,6 +1809,38 @@ bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 }
 
 
+void CCH_read_ahead(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Let the operating system start reading the given
+ *	pages of a page space in background, as they are
+ *	going to be fetched soon. With a shared cache, also
+ *	let the cache prefetcher read them into the buffers.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!count)
+		return;
+
+	const PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceId);
+
+	if (pageSpace && pageSpace->file)
+		PIO_advise_read(dbb, pageSpace->file, pages, count);
+
+	if (bcb->bcb_flags & BCB_cache_prefetcher)
+		bcb->queueReadAhead(pageSpaceId, pages, count);
+}
+
+
 void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 {
 /**************************************
@@ -2008,6 +2059,20 @@ void CCH_shutdown(thread_db* tdbb)
 	}
 #endif
 
+	// Wait for cache prefetcher startup to complete
+
+	while (bcb->bcb_flags & BCB_prefetcher_start)
+		Thread::yield();
+
+	// Shutdown the dedicated cache prefetcher for this database
+
+	if (bcb->bcb_flags & BCB_cache_prefetcher)
+	{
+		bcb->bcb_flags &= ~BCB_cache_prefetcher;
+		bcb->bcb_prefetcher_sem.release(); // Wake up running thread
+		bcb->bcb_prefetcher_fini.waitForCompletion();
+	}
+
 	// Wait for cache writer startup to complete
 
 	while (bcb->bcb_flags & BCB_writer_start)
@@ -2972,6 +3037,118 @@ void BufferControl::cache_writer(BufferControl* bcb)
 }
 
 
+void BufferControl::cache_prefetcher(BufferControl* bcb)
+{
+/**************************************
+ *
+ *	c a c h e _ p r e f e t c h e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read pages queued by CCH_read_ahead into the cache
+ *	while the scans asking for them process other pages.
+ *
+ **************************************/
+	FbLocalStatus status_vector;
+	Database* const dbb = bcb->bcb_database;
+
+	try
+	{
+		UserId user;
+		user.setUserName("Cache Prefetcher");
+
+		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb);
+		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
+		attachment->setStable(sAtt);
+		attachment->att_filename = dbb->dbb_filename;
+		attachment->att_user = &user;
+
+		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
+
+		try
+		{
+			LCK_init(tdbb, LCK_OWNER_attachment);
+			PAG_header(tdbb, true);
+			PAG_attachment_id(tdbb);
+			TRA_init(attachment);
+
+			sAtt->initDone();
+
+			bcb->bcb_flags |= BCB_cache_prefetcher;
+			bcb->bcb_flags &= ~BCB_prefetcher_start;
+
+			// Notify our creator that we have started
+			bcb->bcb_prefetcher_init.release();
+
+			while (bcb->bcb_flags & BCB_cache_prefetcher)
+			{
+				PageNumber page;
+
+				if ((dbb->dbb_flags & DBB_suspend_bgio) || !bcb->getReadAhead(page))
+				{
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_prefetcher_sem.tryEnter(10);
+					continue;
+				}
+
+				// Don't wait for a latched buffer: its page is either
+				// in the cache already or being read by its owner.
+				// A page read here gets the scan count of a large scan,
+				// so the scan that consumes it queues it to the LRU tail
+				// instead of flushing the cache with the prefetched pages.
+
+				WIN window(page);
+				window.win_flags = WIN_large_scan;
+				window.win_scans = 1;
+
+				try
+				{
+					if (CCH_FETCH_TIMEOUT(tdbb, &window, LCK_read, pag_undefined, 0))
+						CCH_RELEASE(tdbb, &window);
+				}
+				catch (const Firebird::Exception&)
+				{
+					// The scan itself reports a page that cannot be read
+					status_vector->init();
+				}
+			}
+		}
+		catch (const Firebird::Exception& ex)
+		{
+			ex.stuffException(&status_vector);
+			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+			// continue execution to clean up
+		}
+
+		Monitoring::cleanupAttachment(tdbb);
+		attachment->releaseLocks(tdbb);
+		LCK_fini(tdbb, LCK_OWNER_attachment);
+
+		attachment->releaseRelations(tdbb);
+	}	// try
+	catch (const Firebird::Exception& ex)
+	{
+		bcb->exceptionHandler(ex, cache_prefetcher);
+	}
+
+	bcb->bcb_flags &= ~BCB_cache_prefetcher;
+
+	try
+	{
+		if (bcb->bcb_flags & BCB_prefetcher_start)
+		{
+			bcb->bcb_flags &= ~BCB_prefetcher_start;
+			bcb->bcb_prefetcher_init.release();
+		}
+	}
+	catch (const Firebird::Exception& ex)
+	{
+		bcb->exceptionHandler(ex, cache_prefetcher);
+	}
+}
+
+
 void BufferControl::exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine*)
 {
 	FbLocalStatus status_vector;
@@ -2980,6 +3157,62 @@ void BufferControl::exceptionHandler(const Firebird::Exception& ex, BcbThreadSyn
 }
 
 
+void BufferControl::queueReadAhead(USHORT pageSpaceId, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	q u e u e R e a d A h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Queue pages for the cache prefetcher. Pages which
+ *	don't fit are left for the scan to read itself.
+ *
+ **************************************/
+	bool queued = false;
+
+	{	// scope
+		MutexLockGuard guard(bcb_read_ahead_mutex, FB_FUNCTION);
+
+		for (; count && bcb_read_ahead_count < READ_AHEAD_QUEUE_SIZE; count--)
+		{
+			const ULONG slot = (bcb_read_ahead_head + bcb_read_ahead_count++) % READ_AHEAD_QUEUE_SIZE;
+			bcb_read_ahead[slot] = PageNumber(pageSpaceId, *pages++);
+			queued = true;
+		}
+	}
+
+	if (queued)
+		bcb_prefetcher_sem.release();
+}
+
+
+bool BufferControl::getReadAhead(PageNumber& page)
+{
+/**************************************
+ *
+ *	g e t R e a d A h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take the next page queued for the cache prefetcher.
+ *
+ **************************************/
+	MutexLockGuard guard(bcb_read_ahead_mutex, FB_FUNCTION);
+
+	if (!bcb_read_ahead_count)
+		return false;
+
+	page = bcb_read_ahead[bcb_read_ahead_head];
+	bcb_read_ahead_head = (bcb_read_ahead_head + 1) % READ_AHEAD_QUEUE_SIZE;
+	bcb_read_ahead_count--;
+
+	return true;
+}
+
+
 static void check_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 {
 /**************************************
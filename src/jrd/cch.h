@@ -26,6 +26,7 @@
 
 #include "../include/fb_blk.h"
 #include "../common/classes/alloc.h"
+#include "../common/classes/locks.h"
 #include "../common/classes/RefCounted.h"
 #include "../common/classes/semaphore.h"
 #include "../common/classes/SyncObject.h"
@@ -72,6 +73,10 @@ const ULONG MAX_PAGE_BUFFERS = 131072;
 const ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// Number of pages the cache prefetcher may have pending.
+
+const ULONG READ_AHEAD_QUEUE_SIZE = 64;
+
 
 // BufferControl -- Buffer control block -- one per system
 
@@ -87,7 +92,8 @@ class BufferControl : public pool_alloc<type_bcb>
 		: bcb_bufferpool(&p),
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
-		  bcb_writer_fini(p, cache_writer, THREAD_medium)
+		  bcb_writer_fini(p, cache_writer, THREAD_medium),
+		  bcb_prefetcher_fini(p, cache_prefetcher, THREAD_medium)
 	{
 		bcb_database = NULL;
 		QUE_INIT(bcb_in_use);
@@ -103,6 +109,8 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
+		bcb_read_ahead_head = 0;
+		bcb_read_ahead_count = 0;
 #ifdef SUPERSERVER_V2
 		bcb_prefetch = NULL;
 #endif
@@ -152,6 +160,16 @@ public:
 	Firebird::Semaphore bcb_writer_sem;		// Wake up cache writer
 	Firebird::Semaphore bcb_writer_init;	// Cache writer initialization
 	BcbThreadSync bcb_writer_fini;			// Cache writer finalization
+
+	static void cache_prefetcher(BufferControl* bcb);
+	Firebird::Semaphore bcb_prefetcher_sem;		// Wake up cache prefetcher
+	Firebird::Semaphore bcb_prefetcher_init;	// Cache prefetcher initialization
+	BcbThreadSync bcb_prefetcher_fini;			// Cache prefetcher finalization
+
+	Firebird::Mutex bcb_read_ahead_mutex;		// Guards the read ahead queue
+	PageNumber	bcb_read_ahead[READ_AHEAD_QUEUE_SIZE];	// Pages queued for the cache prefetcher
+	ULONG		bcb_read_ahead_head;		// First queued page
+	ULONG		bcb_read_ahead_count;		// Number of queued pages
 #ifdef SUPERSERVER_V2
 	static void cache_reader(BufferControl* bcb);
 	// the code in cch.cpp is not tested for semaphore instead event !!!
@@ -164,6 +182,9 @@ public:
 
 	void exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
+	void queueReadAhead(USHORT pageSpaceId, const ULONG* pages, USHORT count);
+	bool getReadAhead(PageNumber& page);
+
 	bcb_repeat*	bcb_rpt;
 };
 
@@ -177,6 +198,8 @@ const int BCB_reader_active	= 32;	// cache reader not blocked on event
 #endif
 const int BCB_free_pending	= 64;	// request cache writer to free pages
 const int BCB_exclusive		= 128;	// there is only BCB in whole system
+const int BCB_cache_prefetcher	= 256;	// cache prefetcher thread has been started
+const int BCB_prefetcher_start	= 512;	// cache prefetcher thread is starting now
 
 
 // BufferDesc -- Buffer descriptor block
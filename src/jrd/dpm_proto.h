@@ -72,6 +72,8 @@ bool	DPM_next(Jrd::thread_db*, Jrd::record_param*, USHORT, bool);
 void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
 #ifdef SUPERSERVER_V2
 SLONG	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::PageBitmap*, SLONG);
+#else
+SINT64	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::RecordBitmap*, SINT64);
 #endif
 void	DPM_scan_pages(Jrd::thread_db*);
 void	DPM_store(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack&, const Jrd::RecordStorageType type);
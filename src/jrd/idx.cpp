@@ -48,6 +48,7 @@
 #include "../jrd/rse.h"
 #include "../jrd/cch.h"
 #include "../common/gdsassert.h"
+#include "../common/ThreadStart.h"
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
@@ -64,6 +65,7 @@
 #include "../jrd/vio_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/Collation.h"
+#include "../dsql/ExprNodes.h"
 
 
 using namespace Jrd;
@@ -79,14 +81,233 @@ struct index_fast_load
 	USHORT ifl_key_length;
 };
 
+// Parallel index build hands out relations in ranges of this many pointer pages
+const ULONG INDEX_RANGE_POINTERS	= 1;
+const int MAX_INDEX_WORKERS			= 16;
+
+// Helpers stop reading records while this many ranges per helper wait to be sorted
+const FB_SIZE_T INDEX_RANGE_BACKLOG	= 2;
+
+static const UCHAR index_worker_tpb[] =
+{
+	isc_tpb_version1, isc_tpb_read,
+	isc_tpb_read_committed, isc_tpb_rec_version,
+	isc_tpb_ignore_limbo
+};
+
+namespace
+{
+	// Parallel index build. The relation is split into ranges of pointer pages.
+	// Helper threads read the records of a range within their own attachments
+	// and turn them into sort records, which the creating attachment puts into
+	// the sort along with the records of the ranges it reads itself.
+
+	class IndexBuildTask
+	{
+	public:
+		enum ItemState { ITEM_TAKEN, ITEM_WAIT, ITEM_NONE };
+
+		struct Item
+		{
+			ULONG ppFrom;			// first pointer page sequence
+			ULONG ppTo;				// pointer page sequence to stop at, zero means the end
+		};
+
+		typedef Array<UCHAR> SortRecords;
+
+		IndexBuildTask(MemoryPool& p, Database* dbb, const jrd_rel* relation, const index_desc* idx,
+				ULONG pointerPages, USHORT keyLength, int nullIndLen, bool largeScan, int workerCount)
+			: m_pool(p), m_dbb(dbb), m_relID(relation->rel_id), m_idx(*idx),
+			  m_keyLength(keyLength), m_nullIndLen(nullIndLen), m_largeScan(largeScan),
+			  m_backlog(workerCount * INDEX_RANGE_BACKLOG),
+			  m_items(p), m_next(0), m_retries(p), m_results(p), m_active(0), m_stopped(false)
+		{
+			const ULONG count = MAX((pointerPages + INDEX_RANGE_POINTERS - 1) / INDEX_RANGE_POINTERS, 1);
+
+			for (ULONG n = 0; n < count; n++)
+			{
+				Item item;
+				item.ppFrom = n * INDEX_RANGE_POINTERS;
+				item.ppTo = (n == count - 1) ? 0 : (n + 1) * INDEX_RANGE_POINTERS;
+				m_items.add(item);
+			}
+		}
+
+		~IndexBuildTask()
+		{
+			while (m_results.hasData())
+				delete m_results.pop();
+		}
+
+		Database* getDatabase() const
+		{
+			return m_dbb;
+		}
+
+		MemoryPool& getPool()
+		{
+			return m_pool;
+		}
+
+		USHORT getRelationId() const
+		{
+			return m_relID;
+		}
+
+		const index_desc* getIndex() const
+		{
+			return &m_idx;
+		}
+
+		USHORT getKeyLength() const
+		{
+			return m_keyLength;
+		}
+
+		int getNullIndLength() const
+		{
+			return m_nullIndLen;
+		}
+
+		bool isLargeScan() const
+		{
+			return m_largeScan;
+		}
+
+		ULONG getRecordSize() const
+		{
+			return m_keyLength + sizeof(index_sort_record);
+		}
+
+		// Take a range to read. The creating attachment also takes the ranges
+		// helpers have failed, and is told to wait while helpers are busy.
+		ItemState getItem(Item& item, bool creator)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_stopped)
+				return ITEM_NONE;
+
+			if (creator && m_retries.hasData())
+			{
+				item = m_retries.pop();
+				return ITEM_TAKEN;
+			}
+
+			if (m_next < m_items.getCount())
+			{
+				item = m_items[m_next++];
+
+				if (!creator)
+					m_active++;
+
+				return ITEM_TAKEN;
+			}
+
+			return (creator && (m_active || m_results.hasData())) ? ITEM_WAIT : ITEM_NONE;
+		}
+
+		// A helper is done with the range, records are NULL if it failed
+		void itemDone(const Item& item, SortRecords* records)
+		{
+			{ // scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				m_active--;
+
+				if (records)
+					m_results.add(records);
+				else
+					m_retries.add(item);
+			}
+
+			m_resultSem.release();
+		}
+
+		SortRecords* getResult()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_results.isEmpty())
+				return NULL;
+
+			SortRecords* const records = m_results.pop();
+			m_mergedSem.release();
+
+			return records;
+		}
+
+		void waitResult()
+		{
+			m_resultSem.tryEnter(0, 100);
+		}
+
+		// Make a helper wait while the creating attachment is behind
+		void waitBacklog()
+		{
+			while (true)
+			{
+				{ // scope
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+					if (m_stopped || m_results.getCount() < m_backlog)
+						return;
+				}
+
+				m_mergedSem.tryEnter(0, 100);
+			}
+		}
+
+		void stop()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			m_stopped = true;
+		}
+
+		bool stopped()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_stopped;
+		}
+
+	private:
+		MemoryPool& m_pool;
+		Database* const m_dbb;
+		const USHORT m_relID;
+		const index_desc m_idx;
+		const USHORT m_keyLength;
+		const int m_nullIndLen;
+		const bool m_largeScan;
+		const FB_SIZE_T m_backlog;
+		Mutex m_mutex;
+		Semaphore m_resultSem;
+		Semaphore m_mergedSem;
+		Array<Item> m_items;
+		FB_SIZE_T m_next;
+		Array<Item> m_retries;
+		Array<SortRecords*> m_results;
+		ULONG m_active;
+		bool m_stopped;
+	};
+}
+
 static idx_e check_duplicates(thread_db*, Record*, index_desc*, index_insertion*, jrd_rel*);
 static idx_e check_foreign_key(thread_db*, Record*, jrd_rel*, jrd_tra*, index_desc*, IndexErrorContext&);
 static idx_e check_partner_index(thread_db*, jrd_rel*, Record*, jrd_tra*, index_desc*, jrd_rel*, USHORT);
+static bool collect_fields(thread_db*, const ExprNode*, const jrd_rel*, SortedArray<USHORT>&);
 static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
+static bool extract_range(thread_db*, IndexBuildTask*, jrd_tra*, const IndexBuildTask::Item&,
+	IndexBuildTask::SortRecords&);
+static bool field_equal(jrd_rel*, Record*, Record*, USHORT);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
+static THREAD_ENTRY_DECLARE index_worker(THREAD_ENTRY_PARAM);
+static void index_worker_main(thread_db*, void*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
 static bool key_equal(const temporary_key*, const temporary_key*);
+static bool key_fields_equal(jrd_rel*, const index_desc*, Record*, Record*);
+static void make_sort_record(UCHAR*, const temporary_key&, const index_desc*, USHORT, int, SINT64, bool);
+static bool next_range(thread_db*, IndexBuildTask*, Sort*, const index_fast_load&, IndexBuildTask::Item&);
 static void release_index_block(thread_db*, IndexBlock*);
 static void signal_index_deletion(thread_db*, jrd_rel*, USHORT);
 
@@ -305,7 +526,6 @@ void IDX_create_index(thread_db* tdbb,
 		*index_id = idx->idx_id;
 
 	RecordStack stack;
-	const UCHAR pad = isDescending ? -1 : 0;
 
 	index_fast_load ifl_data;
 	ifl_data.ifl_dup_recno = -1;
@@ -358,144 +578,221 @@ void IDX_create_index(thread_db* tdbb,
 		}
 	}
 
+	// The whole relation is going to be read anyway, so let the OS fetch
+	// data pages ahead of the scan even when the cache is not shared.
+	primary.getWindow(tdbb).win_flags |= WIN_read_ahead;
+
 	IndexErrorContext context(relation, idx, index_name);
 
-	// Loop thru the relation computing index keys.  If there are old versions, find them, too.
-	temporary_key key;
-	while (DPM_next(tdbb, &primary, LCK_read, false))
+	// Superserver may compute the keys in several threads. Keys of expressions and
+	// checks of foreign keys need the requests and the transaction of this attachment.
+
+	const int workerCount = MIN(dbb->dbb_config->getIndexBuildWorkers(), MAX_INDEX_WORKERS);
+	const RelationPages* const relPages = relation->getPages(tdbb);
+
+	IndexBuildTask* task = NULL;
+	HalfStaticArray<Thread::Handle, 8> helpers;
+
+	if (workerCount > 1 && (dbb->dbb_flags & DBB_shared) && !relation->isTemporary() &&
+		!idx->idx_expression && !isForeign && relPages->rel_pages &&
+		relPages->rel_pages->count() > INDEX_RANGE_POINTERS)
 	{
-		if (!VIO_garbage_collect(tdbb, &primary, transaction))
-			continue;
+		task = FB_NEW_POOL(*attachment->att_pool) IndexBuildTask(*attachment->att_pool, dbb,
+			relation, idx, relPages->rel_pages->count(), key_length, nullIndLen,
+			(primary.getWindow(tdbb).win_flags & WIN_large_scan), workerCount);
 
-		const bool deleted = primary.rpb_flags & rpb_deleted;
+		// Failure to start any of the helpers is not fatal
 
-		if (deleted)
-			CCH_RELEASE(tdbb, &primary.getWindow(tdbb));
-		else
+		for (int n = 1; n < workerCount; n++)
 		{
-			primary.rpb_record = gc_record;
-			VIO_data(tdbb, &primary, relation->rel_pool);
-			stack.push(primary.rpb_record);
-		}
+			Thread::Handle handle;
 
-		secondary.rpb_page = primary.rpb_b_page;
-		secondary.rpb_line = primary.rpb_b_line;
-		secondary.rpb_prior = primary.rpb_prior;
+			try
+			{
+				Thread::start(index_worker, task, THREAD_medium, &handle);
+			}
+			catch (const Firebird::Exception& ex)
+			{
+				iscLogException("cannot start index build helper thread", ex);
+				break;
+			}
 
-		while (secondary.rpb_page)
-		{
-			if (!DPM_fetch(tdbb, &secondary, LCK_read))
-				break;			// must be garbage collected
-
-			secondary.rpb_record = NULL;
-			VIO_data(tdbb, &secondary, relation->rel_pool);
-			stack.push(secondary.rpb_record);
-			secondary.rpb_page = secondary.rpb_b_page;
-			secondary.rpb_line = secondary.rpb_b_line;
+			helpers.add(handle);
 		}
+	}
 
-		while (stack.hasData())
-		{
-			Record* record = stack.pop();
+	const SINT64 ppRecords = (SINT64) dbb->dbb_dp_per_pp * dbb->dbb_max_records;
+	IndexBuildTask::Item item;
+	item.ppFrom = item.ppTo = 0;
+
+	try
+	{
+		// Loop thru the ranges of the relation, the whole of it unless helped by other threads
 
-			result = BTR_key(tdbb, relation, record, idx, &key, false);
+		while (!task || next_range(tdbb, task, scb, ifl_data, item))
+		{
+			primary.rpb_number.setValue((SINT64) item.ppFrom * ppRecords + BOF_NUMBER);
+			const RecordNumber last((SINT64) item.ppTo * ppRecords);
 
-			if (result == idx_e_ok)
+			// Loop thru the relation computing index keys.  If there are old versions, find them, too.
+			temporary_key key;
+			while (DPM_next(tdbb, &primary, LCK_read, false))
 			{
-				if (isPrimary && key.key_nulls != 0)
+				if (item.ppTo && primary.rpb_number >= last)
 				{
-					const USHORT key_null_segment = getNullSegment(key);
-					fb_assert(key_null_segment < idx->idx_count);
-					const USHORT bad_id = idx->idx_rpt[key_null_segment].idx_field;
-					const jrd_fld *bad_fld = MET_get_field(relation, bad_id);
+					CCH_RELEASE(tdbb, &primary.getWindow(tdbb));
+					break;
+				}
+
+				if (!VIO_garbage_collect(tdbb, &primary, transaction))
+					continue;
+
+				const bool deleted = primary.rpb_flags & rpb_deleted;
 
-					ERR_post(Arg::Gds(isc_not_valid) << Arg::Str(bad_fld->fld_name) <<
-														Arg::Str(NULL_STRING_MARK));
+				if (deleted)
+					CCH_RELEASE(tdbb, &primary.getWindow(tdbb));
+				else
+				{
+					primary.rpb_record = gc_record;
+					VIO_data(tdbb, &primary, relation->rel_pool);
+					stack.push(primary.rpb_record);
 				}
 
-				// If foreign key index is being defined, make sure foreign
-				// key definition will not be violated
+				secondary.rpb_page = primary.rpb_b_page;
+				secondary.rpb_line = primary.rpb_b_line;
+				secondary.rpb_prior = primary.rpb_prior;
 
-				if (isForeign && key.key_nulls == 0)
+				while (secondary.rpb_page)
 				{
-					result = check_partner_index(tdbb, relation, record, transaction, idx,
-												 partner_relation, partner_index_id);
+					if (!DPM_fetch(tdbb, &secondary, LCK_read))
+						break;			// must be garbage collected
+
+					secondary.rpb_record = NULL;
+					VIO_data(tdbb, &secondary, relation->rel_pool);
+					stack.push(secondary.rpb_record);
+					secondary.rpb_page = secondary.rpb_b_page;
+					secondary.rpb_line = secondary.rpb_b_line;
 				}
-			}
 
-			if (result != idx_e_ok)
-			{
-				do {
-					if (record != gc_record)
-						delete record;
-				} while (stack.hasData() && (record = stack.pop()));
+				while (stack.hasData())
+				{
+					Record* record = stack.pop();
 
-				if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
-					--relation->rel_scan_count;
+					result = BTR_key(tdbb, relation, record, idx, &key, false);
 
-				context.raise(tdbb, result, record);
-			}
+					if (result == idx_e_ok)
+					{
+						if (isPrimary && key.key_nulls != 0)
+						{
+							const USHORT key_null_segment = getNullSegment(key);
+							fb_assert(key_null_segment < idx->idx_count);
+							const USHORT bad_id = idx->idx_rpt[key_null_segment].idx_field;
+							const jrd_fld *bad_fld = MET_get_field(relation, bad_id);
+
+							ERR_post(Arg::Gds(isc_not_valid) << Arg::Str(bad_fld->fld_name) <<
+																Arg::Str(NULL_STRING_MARK));
+						}
+
+						// If foreign key index is being defined, make sure foreign
+						// key definition will not be violated
+
+						if (isForeign && key.key_nulls == 0)
+						{
+							result = check_partner_index(tdbb, relation, record, transaction, idx,
+														 partner_relation, partner_index_id);
+						}
+					}
 
-			if (key.key_length > key_length)
-			{
-				do {
-					if (record != gc_record)
-						delete record;
-				} while (stack.hasData() && (record = stack.pop()));
+					if (result != idx_e_ok)
+					{
+						do {
+							if (record != gc_record)
+								delete record;
+						} while (stack.hasData() && (record = stack.pop()));
 
-				if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
-					--relation->rel_scan_count;
+						if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
+							--relation->rel_scan_count;
 
-				context.raise(tdbb, idx_e_keytoobig, record);
-			}
+						context.raise(tdbb, result, record);
+					}
 
-			UCHAR* p;
-			scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+					if (key.key_length > key_length)
+					{
+						do {
+							if (record != gc_record)
+								delete record;
+						} while (stack.hasData() && (record = stack.pop()));
 
-			// try to catch duplicates early
+						if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
+							--relation->rel_scan_count;
+
+						context.raise(tdbb, idx_e_keytoobig, record);
+					}
+
+					UCHAR* p;
+					scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+					// try to catch duplicates early
+
+					if (ifl_data.ifl_duplicates > 0)
+					{
+						do {
+							if (record != gc_record)
+								delete record;
+						} while (stack.hasData() && (record = stack.pop()));
+
+						break;
+					}
+
+					make_sort_record(p, key, idx, key_length, nullIndLen, primary.rpb_number.getValue(),
+						stack.hasData() || deleted);
 
-			if (ifl_data.ifl_duplicates > 0)
-			{
-				do {
 					if (record != gc_record)
 						delete record;
-				} while (stack.hasData() && (record = stack.pop()));
+				}
 
-				break;
+				if (ifl_data.ifl_duplicates > 0)
+					break;
+
+				if (--tdbb->tdbb_quantum < 0)
+					JRD_reschedule(tdbb, 0, true);
 			}
 
-			if (nullIndLen)
-				*p++ = (key.key_length == 0) ? 0 : 1;
+			if (!task || ifl_data.ifl_duplicates > 0)
+				break;
+		}
+	}
+	catch (const Firebird::Exception&)
+	{
+		if (task)
+		{
+			task->stop();
+
+			{ // scope
+				EngineCheckout cout(tdbb, FB_FUNCTION);
 
-			if (key.key_length > 0)
-			{
-				memcpy(p, key.key_data, key.key_length);
-				p += key.key_length;
+				for (FB_SIZE_T i = 0; i < helpers.getCount(); i++)
+					Thread::waitForCompletion(helpers[i]);
 			}
 
-			int l = int(key_length) - nullIndLen - key.key_length;	// must be signed
+			delete task;
+		}
 
-			if (l > 0)
-			{
-				memset(p, pad, l);
-				p += l;
-			}
+		throw;
+	}
 
-			const bool key_is_null = (key.key_nulls == (1 << idx->idx_count) - 1);
+	if (task)
+	{
+		task->stop();
 
-			index_sort_record* isr = (index_sort_record*) p;
-			isr->isr_record_number = primary.rpb_number.getValue();
-			isr->isr_key_length = key.key_length;
-			isr->isr_flags = ((stack.hasData() || deleted) ? ISR_secondary : 0) | (key_is_null ? ISR_null : 0);
-			if (record != gc_record)
-				delete record;
-		}
+		{ // scope
+			EngineCheckout cout(tdbb, FB_FUNCTION);
 
-		if (ifl_data.ifl_duplicates > 0)
-			break;
+			for (FB_SIZE_T i = 0; i < helpers.getCount(); i++)
+				Thread::waitForCompletion(helpers[i]);
+		}
 
-		if (--tdbb->tdbb_quantum < 0)
-			JRD_reschedule(tdbb, 0, true);
+		delete task;
 	}
 
 	gc_record.release();
@@ -603,7 +900,7 @@ void IDX_delete_index(thread_db* tdbb, jrd_rel* relation, USHORT id)
 	WIN window(get_root_page(tdbb, relation));
 	CCH_FETCH(tdbb, &window, LCK_write, pag_root);
 
-	const bool tree_exists = BTR_delete_index(tdbb, &window, id);
+	const bool tree_exists = BTR_delete_index(tdbb, &window, id, relation->getPages(tdbb));
 
 	if ((relation->rel_flags & REL_temp_conn) && (relation->getPages(tdbb)->rel_instance_id != 0) &&
 		tree_exists)
@@ -643,7 +940,7 @@ void IDX_delete_indices(thread_db* tdbb, jrd_rel* relation, RelationPages* relPa
 
 	for (USHORT i = 0; i < root->irt_count; i++)
 	{
-		const bool tree_exists = BTR_delete_index(tdbb, &window, i);
+		const bool tree_exists = BTR_delete_index(tdbb, &window, i, relPages);
 		root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_root);
 
 		if (is_temp && tree_exists)
@@ -702,6 +999,40 @@ void IDX_erase(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 }
 
 
+void IDX_expression_fields(thread_db* tdbb, jrd_rel* relation, index_desc* idx)
+{
+/**************************************
+ *
+ *	I D X _ e x p r e s s i o n _ f i e l d s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find out which fields the expression of an
+ *	index depends on. If it may depend on anything
+ *	else (variables, context, other tables, etc)
+ *	leave the list empty.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	idx->idx_expression_fields = NULL;
+
+	if (!idx->idx_expression || !idx->idx_expression_statement)
+		return;
+
+	// The list lives as long as the expression statement does
+	SortedArray<USHORT>* const fields =
+		FB_NEW_POOL(*idx->idx_expression_statement->pool) SortedArray<USHORT>(
+			*idx->idx_expression_statement->pool);
+
+	if (collect_fields(tdbb, idx->idx_expression, relation, *fields) && fields->hasData())
+		idx->idx_expression_fields = fields;
+	else
+		delete fields;
+}
+
+
 void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going, RecordStack& staying)
 {
 /**************************************
@@ -850,6 +1181,11 @@ void IDX_modify(thread_db* tdbb,
 
 	while (BTR_next_index(tdbb, org_rpb->rpb_relation, transaction, &idx, &window))
 	{
+		// Don't bother computing keys if the fields they depend on are the same
+
+		if (key_fields_equal(org_rpb->rpb_relation, &idx, org_rpb->rpb_record, new_rpb->rpb_record))
+			continue;
+
 		IndexErrorContext context(new_rpb->rpb_relation, &idx);
 		idx_e error_code;
 
@@ -919,6 +1255,7 @@ void IDX_modify_check_constraints(thread_db* tdbb,
 	while (BTR_next_index(tdbb, org_rpb->rpb_relation, transaction, &idx, &window))
 	{
 		if (!(idx.idx_flags & (idx_primary | idx_unique)) ||
+			key_fields_equal(org_rpb->rpb_relation, &idx, org_rpb->rpb_record, new_rpb->rpb_record) ||
 			!MET_lookup_partner(tdbb, org_rpb->rpb_relation, &idx, 0))
 		{
 			continue;
@@ -954,6 +1291,74 @@ void IDX_modify_check_constraints(thread_db* tdbb,
 }
 
 
+FB_UINT64 IDX_refresh_statistics(thread_db* tdbb, jrd_rel* relation)
+{
+/**************************************
+ *
+ *	I D X _ r e f r e s h _ s t a t i s t i c s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Recompute selectivity of all indices of
+ *	a relation from a sample of leaf pages.
+ *	Indices being dropped are skipped. Return
+ *	the largest estimated number of entries.
+ *
+ **************************************/
+	const ULONG SAMPLE_PAGES = 256;
+
+	SET_TDBB(tdbb);
+
+	HalfStaticArray<USHORT, 16> ids;
+
+	index_desc idx;
+	idx.idx_id = idx_invalid;
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	while (BTR_next_index(tdbb, relation, NULL, &idx, &window))
+		ids.add(idx.idx_id);
+
+	FB_UINT64 records = 0;
+
+	for (const USHORT* id = ids.begin(); id != ids.end(); ++id)
+	{
+		IndexLock* const idx_lock = CMP_get_index_lock(tdbb, relation, *id);
+		if (idx_lock)
+		{
+			if (!idx_lock->idl_count && !LCK_lock(tdbb, idx_lock->idl_lock, LCK_SR, LCK_NO_WAIT))
+			{
+				// clear lock error from status vector
+				fb_utils::init_status(tdbb->tdbb_status_vector);
+				continue;
+			}
+
+			++idx_lock->idl_count;
+		}
+
+		SelectivityList selectivity(*tdbb->getDefaultPool());
+
+		try
+		{
+			const FB_UINT64 nodes = BTR_selectivity(tdbb, relation, *id, selectivity, SAMPLE_PAGES);
+			records = MAX(records, nodes);
+		}
+		catch (const Exception&)
+		{
+			if (idx_lock && !--idx_lock->idl_count)
+				LCK_release(tdbb, idx_lock->idl_lock);
+			throw;
+		}
+
+		if (idx_lock && !--idx_lock->idl_count)
+			LCK_release(tdbb, idx_lock->idl_lock);
+	}
+
+	return records;
+}
+
+
 void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
 {
 /**************************************
@@ -1358,6 +1763,83 @@ static idx_e check_partner_index(thread_db* tdbb,
 }
 
 
+static bool collect_fields(thread_db* tdbb, const ExprNode* node, const jrd_rel* relation,
+						   SortedArray<USHORT>& fields)
+{
+/**************************************
+ *
+ *	c o l l e c t _ f i e l d s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Collect ids of the fields an index expression
+ *	refers to. Return false if the expression may
+ *	depend on anything but these fields.
+ *
+ **************************************/
+	switch (node->type)
+	{
+		case ExprNode::TYPE_FIELD:
+		{
+			const FieldNode* const fieldNode = static_cast<const FieldNode*>(node);
+			const vec<jrd_fld*>* const vector = relation->rel_fields;
+
+			if (fieldNode->fieldStream != 0 || !vector || fieldNode->fieldId >= vector->count())
+				return false;
+
+			const jrd_fld* const field = (*vector)[fieldNode->fieldId];
+			if (!field || field->fld_computation)
+				return false;
+
+			if (!fields.exist(fieldNode->fieldId))
+				fields.add(fieldNode->fieldId);
+
+			return true;
+		}
+
+		case ExprNode::TYPE_ARITHMETIC:
+		case ExprNode::TYPE_BOOL_AS_VALUE:
+		case ExprNode::TYPE_CAST:
+		case ExprNode::TYPE_COALESCE:
+		case ExprNode::TYPE_COLLATE:
+		case ExprNode::TYPE_CONCATENATE:
+		case ExprNode::TYPE_DECODE:
+		case ExprNode::TYPE_EXTRACT:
+		case ExprNode::TYPE_LITERAL:
+		case ExprNode::TYPE_NEGATE:
+		case ExprNode::TYPE_NULL:
+		case ExprNode::TYPE_STR_CASE:
+		case ExprNode::TYPE_STR_LEN:
+		case ExprNode::TYPE_SUBSTRING:
+		case ExprNode::TYPE_SUBSTRING_SIMILAR:
+		case ExprNode::TYPE_TRIM:
+		case ExprNode::TYPE_VALUE_IF:
+		case ExprNode::TYPE_BINARY_BOOL:
+		case ExprNode::TYPE_COMPARATIVE_BOOL:
+		case ExprNode::TYPE_MISSING_BOOL:
+		case ExprNode::TYPE_NOT_BOOL:
+		case ExprNode::TYPE_VALUE_LIST:
+			break;
+
+		default:
+			// functions, variables, context values, subqueries and so on
+			return false;
+	}
+
+	NodeRefsHolder holder(*tdbb->getDefaultPool());
+	node->getChildren(holder, false);
+
+	for (const NodeRef* const* i = holder.refs.begin(); i != holder.refs.end(); ++i)
+	{
+		if (**i && !collect_fields(tdbb, (*i)->getExpr(), relation, fields))
+			return false;
+	}
+
+	return true;
+}
+
+
 static bool duplicate_key(const UCHAR* record1, const UCHAR* record2, void* ifl_void)
 {
 /**************************************
@@ -1386,6 +1868,201 @@ static bool duplicate_key(const UCHAR* record1, const UCHAR* record2, void* ifl_
 }
 
 
+static bool extract_range(thread_db* tdbb, IndexBuildTask* task, jrd_tra* transaction,
+	const IndexBuildTask::Item& item, IndexBuildTask::SortRecords& records)
+{
+/**************************************
+ *
+ *	e x t r a c t _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute index keys of the records stored on the data pages
+ *	of a range of pointer pages, including their old versions,
+ *	and append them to the array of sort records. Return false
+ *	if the range can't be done here, so the creating attachment
+ *	redoes it and reports the error, if any.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	jrd_rel* const relation = MET_lookup_relation_id(tdbb, task->getRelationId(), false);
+
+	if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
+		return false;
+
+	if (!relation->getPages(tdbb)->rel_pages)
+	{
+		DPM_scan_pages(tdbb);
+
+		if (!relation->getPages(tdbb)->rel_pages)
+			return false;
+	}
+
+	index_desc idx = *task->getIndex();
+	const USHORT key_length = task->getKeyLength();
+	const int nullIndLen = task->getNullIndLength();
+	const bool isPrimary = (idx.idx_flags & idx_primary);
+
+	const SINT64 ppRecords = (SINT64) dbb->dbb_dp_per_pp * dbb->dbb_max_records;
+	const RecordNumber last((SINT64) item.ppTo * ppRecords);
+
+	record_param primary, secondary;
+	secondary.rpb_relation = relation;
+	primary.rpb_relation = relation;
+	primary.rpb_number.setValue((SINT64) item.ppFrom * ppRecords + BOF_NUMBER);
+
+	if (task->isLargeScan())
+	{
+		primary.getWindow(tdbb).win_flags = secondary.getWindow(tdbb).win_flags = WIN_large_scan;
+		primary.rpb_org_scans = secondary.rpb_org_scans = relation->rel_scan_count++;
+	}
+
+	primary.getWindow(tdbb).win_flags |= WIN_read_ahead;
+
+	AutoGCRecord gc_record(VIO_gc_record(tdbb, relation));
+	RecordStack stack;
+	bool success = true;
+
+	try
+	{
+		temporary_key key;
+		while (success && DPM_next(tdbb, &primary, LCK_read, false))
+		{
+			if (item.ppTo && primary.rpb_number >= last)
+			{
+				CCH_RELEASE(tdbb, &primary.getWindow(tdbb));
+				break;
+			}
+
+			if (!VIO_garbage_collect(tdbb, &primary, transaction))
+				continue;
+
+			const bool deleted = primary.rpb_flags & rpb_deleted;
+
+			if (deleted)
+				CCH_RELEASE(tdbb, &primary.getWindow(tdbb));
+			else
+			{
+				primary.rpb_record = gc_record;
+				VIO_data(tdbb, &primary, relation->rel_pool);
+				stack.push(primary.rpb_record);
+			}
+
+			secondary.rpb_page = primary.rpb_b_page;
+			secondary.rpb_line = primary.rpb_b_line;
+			secondary.rpb_prior = primary.rpb_prior;
+
+			while (secondary.rpb_page)
+			{
+				if (!DPM_fetch(tdbb, &secondary, LCK_read))
+					break;			// must be garbage collected
+
+				secondary.rpb_record = NULL;
+				VIO_data(tdbb, &secondary, relation->rel_pool);
+				stack.push(secondary.rpb_record);
+				secondary.rpb_page = secondary.rpb_b_page;
+				secondary.rpb_line = secondary.rpb_b_line;
+			}
+
+			while (stack.hasData())
+			{
+				Record* const record = stack.pop();
+
+				// Errors are left to the creating attachment
+
+				if (success)
+				{
+					const idx_e result = BTR_key(tdbb, relation, record, &idx, &key, false);
+
+					if (result != idx_e_ok || key.key_length > key_length ||
+						(isPrimary && key.key_nulls != 0))
+					{
+						success = false;
+					}
+					else
+					{
+						const FB_SIZE_T size = task->getRecordSize();
+						const FB_SIZE_T offset = records.getCount();
+
+						make_sort_record(records.getBuffer(offset + size) + offset, key, &idx,
+							key_length, nullIndLen, primary.rpb_number.getValue(),
+							stack.hasData() || deleted);
+					}
+				}
+
+				if (record != gc_record)
+					delete record;
+			}
+
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, 0, true);
+
+			if (task->stopped())
+				success = false;
+		}
+	}
+	catch (const Firebird::Exception&)
+	{
+		while (stack.hasData())
+		{
+			Record* const record = stack.pop();
+
+			if (record != gc_record)
+				delete record;
+		}
+
+		if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
+			--relation->rel_scan_count;
+
+		throw;
+	}
+
+	if (primary.getWindow(tdbb).win_flags & WIN_large_scan)
+		--relation->rel_scan_count;
+
+	return success;
+}
+
+
+static bool field_equal(jrd_rel* relation, Record* record1, Record* record2, USHORT id)
+{
+/**************************************
+ *
+ *	f i e l d _ e q u a l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a field is binary equal in two
+ *	records of the same format.
+ *
+ **************************************/
+	dsc desc1, desc2;
+	const bool notNull1 = EVL_field(relation, record1, id, &desc1);
+	const bool notNull2 = EVL_field(relation, record2, id, &desc2);
+
+	if (notNull1 != notNull2)
+		return false;
+
+	if (!notNull1)
+		return true;
+
+	if (desc1.dsc_dtype != desc2.dsc_dtype || desc1.dsc_length != desc2.dsc_length)
+		return false;
+
+	// Don't compare garbage past the actual length of a varying string,
+	// the length prefix itself is compared together with the data
+
+	ULONG length = desc1.dsc_length;
+	if (desc1.dsc_dtype == dtype_varying)
+		length = sizeof(USHORT) + reinterpret_cast<const vary*>(desc1.dsc_address)->vary_length;
+
+	return (length <= desc1.dsc_length && !memcmp(desc1.dsc_address, desc2.dsc_address, length));
+}
+
+
 static PageNumber get_root_page(thread_db* tdbb, jrd_rel* relation)
 {
 /**************************************
@@ -1445,6 +2122,97 @@ static int index_block_flush(void* ast_object)
 }
 
 
+static THREAD_ENTRY_DECLARE index_worker(THREAD_ENTRY_PARAM arg)
+{
+/**************************************
+ *
+ *	i n d e x _ w o r k e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Helper thread of parallel index build.
+ *
+ **************************************/
+	IndexBuildTask* const task = static_cast<IndexBuildTask*>(arg);
+
+	VIO_run_background(task->getDatabase(), "Index Builder", 0, index_worker_main, task);
+
+	return 0;
+}
+
+
+static void index_worker_main(thread_db* tdbb, void* arg)
+{
+/**************************************
+ *
+ *	i n d e x _ w o r k e r _ m a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute index keys of ranges of the relation using
+ *	own transaction until there's nothing left. Ranges
+ *	which fail are handed back to the creating attachment.
+ *
+ **************************************/
+	IndexBuildTask* const task = static_cast<IndexBuildTask*>(arg);
+	Database* const dbb = tdbb->getDatabase();
+
+	jrd_tra* transaction = NULL;
+
+	try
+	{
+		transaction = TRA_start(tdbb, sizeof(index_worker_tpb), index_worker_tpb);
+		tdbb->setTransaction(transaction);
+
+		// Relations of a new attachment don't know their pointer pages yet
+
+		DPM_scan_pages(tdbb);
+
+		IndexBuildTask::Item item;
+
+		while (task->getItem(item, false) == IndexBuildTask::ITEM_TAKEN)
+		{
+			IndexBuildTask::SortRecords* records =
+				FB_NEW_POOL(task->getPool()) IndexBuildTask::SortRecords(task->getPool());
+
+			bool success = false;
+
+			try
+			{
+				success = extract_range(tdbb, task, transaction, item, *records);
+			}
+			catch (const Firebird::Exception&)
+			{
+				delete records;
+				task->itemDone(item, NULL);
+				throw;
+			}
+
+			if (!success)
+			{
+				delete records;
+				records = NULL;
+			}
+
+			task->itemDone(item, records);
+			task->waitBacklog();
+		}
+	}
+	catch (const Firebird::Exception& ex)
+	{
+		FbLocalStatus status_vector;
+		ex.stuffException(&status_vector);
+		iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+		// continue execution to clean up
+	}
+
+	if (transaction)
+		TRA_commit(tdbb, transaction, false);
+}
+
+
 static idx_e insert_key(thread_db* tdbb,
 						jrd_rel* relation,
 						Record* record,
@@ -1584,6 +2352,151 @@ static bool key_equal(const temporary_key* key1, const temporary_key* key2)
 }
 
 
+static bool key_fields_equal(jrd_rel* relation, const index_desc* idx,
+							 Record* record1, Record* record2)
+{
+/**************************************
+ *
+ *	k e y _ f i e l d s _ e q u a l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether all the fields an index key is
+ *	computed from are the same in two versions
+ *	of a record, so the keys are the same too.
+ *
+ **************************************/
+	if (!record1 || !record2 || record1->getFormat() != record2->getFormat())
+		return false;
+
+	if (idx->idx_flags & idx_expressn)
+	{
+		const SortedArray<USHORT>* const fields = idx->idx_expression_fields;
+		if (!fields)
+			return false;
+
+		for (const USHORT* id = fields->begin(); id != fields->end(); ++id)
+		{
+			if (!field_equal(relation, record1, record2, *id))
+				return false;
+		}
+
+		return true;
+	}
+
+	for (USHORT i = 0; i < idx->idx_count; i++)
+	{
+		if (!field_equal(relation, record1, record2, idx->idx_rpt[i].idx_field))
+			return false;
+	}
+
+	return true;
+}
+
+
+static void make_sort_record(UCHAR* p, const temporary_key& key, const index_desc* idx,
+	USHORT key_length, int nullIndLen, SINT64 recordNumber, bool secondary)
+{
+/**************************************
+ *
+ *	m a k e _ s o r t _ r e c o r d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fill the record to sort for index creation with the
+ *	key padded to its full length and the record number.
+ *
+ **************************************/
+	if (nullIndLen)
+		*p++ = (key.key_length == 0) ? 0 : 1;
+
+	if (key.key_length > 0)
+	{
+		memcpy(p, key.key_data, key.key_length);
+		p += key.key_length;
+	}
+
+	int l = int(key_length) - nullIndLen - key.key_length;	// must be signed
+
+	if (l > 0)
+	{
+		memset(p, (idx->idx_flags & idx_descending) ? -1 : 0, l);
+		p += l;
+	}
+
+	const bool key_is_null = (key.key_nulls == (1 << idx->idx_count) - 1);
+
+	index_sort_record* isr = (index_sort_record*) p;
+	isr->isr_record_number = recordNumber;
+	isr->isr_key_length = key.key_length;
+	isr->isr_flags = (secondary ? ISR_secondary : 0) | (key_is_null ? ISR_null : 0);
+}
+
+
+static bool next_range(thread_db* tdbb, IndexBuildTask* task, Sort* scb,
+	const index_fast_load& ifl_data, IndexBuildTask::Item& item)
+{
+/**************************************
+ *
+ *	n e x t _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put the records computed by helper threads into
+ *	the sort and take the next range of the relation
+ *	to read. Return false if there's nothing left or
+ *	a duplicate is found.
+ *
+ **************************************/
+	const ULONG size = task->getRecordSize();
+
+	while (true)
+	{
+		IndexBuildTask::SortRecords* records;
+
+		while ( (records = task->getResult()) )
+		{
+			for (FB_SIZE_T offset = 0; offset < records->getCount(); offset += size)
+			{
+				UCHAR* p;
+				scb->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+				// try to catch duplicates early
+
+				if (ifl_data.ifl_duplicates > 0)
+				{
+					delete records;
+					return false;
+				}
+
+				memcpy(p, records->begin() + offset, size);
+			}
+
+			delete records;
+		}
+
+		switch (task->getItem(item, true))
+		{
+		case IndexBuildTask::ITEM_TAKEN:
+			return true;
+
+		case IndexBuildTask::ITEM_NONE:
+			return false;
+
+		default:
+			{ // scope
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				task->waitResult();
+			}
+			break;
+		}
+	}
+}
+
+
 static void release_index_block(thread_db* tdbb, IndexBlock* index_block)
 {
 /**************************************
@@ -1601,6 +2514,7 @@ static void release_index_block(thread_db* tdbb, IndexBlock* index_block)
 
 	index_block->idb_expression_statement = NULL;
 	index_block->idb_expression = NULL;
+	index_block->idb_expression_fields = NULL;
 	MOVE_CLEAR(&index_block->idb_expression_desc, sizeof(dsc));
 
 	LCK_release(tdbb, index_block->idb_lock);
@@ -7250,6 +7250,9 @@ bool JRD_shutdown_database(Database* dbb, const unsigned flags)
 	if (dbb->dbb_sweep_lock)
 		LCK_release(tdbb, dbb->dbb_sweep_lock);
 
+	if (dbb->dbb_tip_cache)
+		dbb->dbb_tip_cache->shutdown(tdbb);
+
 	if (dbb->dbb_lock)
 		LCK_release(tdbb, dbb->dbb_lock);
 
@@ -288,6 +288,7 @@ public:
 	IndexBlock*	idb_next;
 	ValueExprNode* idb_expression;			// node tree for index expression
 	JrdStatement* idb_expression_statement;	// statement for index expression evaluation
+	Firebird::SortedArray<USHORT>* idb_expression_fields;	// fields the expression depends on
 	dsc			idb_expression_desc;		// descriptor for expression result
 	Lock*		idb_lock;					// lock to synchronize changes to index
 	USHORT		idb_id;
@@ -348,6 +349,7 @@ const USHORT WIN_large_scan			= 1;	// large sequential scan
 const USHORT WIN_secondary			= 2;	// secondary stream
 const USHORT WIN_garbage_collector	= 4;	// garbage collector's window
 const USHORT WIN_garbage_collect	= 8;	// scan left a page for garbage collector
+const USHORT WIN_read_ahead			= 16;	// read data pages ahead of the scan
 
 
 #ifdef USE_ITIMER
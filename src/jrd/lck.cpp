@@ -549,6 +549,7 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_sweep:
 	case LCK_crypt:
 	case LCK_crypt_status:
+	case LCK_tpc_init:
 		owner_type = LCK_OWNER_database;
 		break;
 
@@ -836,6 +837,31 @@ void LCK_re_post(thread_db* tdbb, Lock* lock)
 }
 
 
+bool LCK_test(thread_db* tdbb, Lock* lock, USHORT level)
+{
+/**************************************
+ *
+ *	L C K _ t e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a lock could be granted at the given
+ *	level right now, without taking it. The same as
+ *	a no-wait LCK_lock immediately followed by LCK_release.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	fb_assert(LCK_CHECK_LOCK(lock));
+	fb_assert(!lock->lck_compatible && !lock->lck_id);
+
+	return dbb->dbb_lock_mgr->testLock(lock->lck_type, lock->getKeyPtr(), lock->lck_length,
+		level, lock->lck_owner_handle);
+}
+
+
 void LCK_write_data(thread_db* tdbb, Lock* lock, SINT64 data)
 {
 /**************************************
@@ -44,6 +44,7 @@ SINT64	LCK_query_data(Jrd::thread_db*, Jrd::lck_t, USHORT);
 SINT64	LCK_read_data(Jrd::thread_db*, Jrd::Lock*);
 void	LCK_release(Jrd::thread_db*, Jrd::Lock*);
 void	LCK_re_post(Jrd::thread_db*, Jrd::Lock*);
+bool	LCK_test(Jrd::thread_db*, Jrd::Lock*, USHORT);
 void	LCK_write_data(Jrd::thread_db*, Jrd::Lock*, SINT64);
 
 
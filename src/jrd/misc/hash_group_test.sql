@@ -0,0 +1,208 @@
+/*
+ *	PROGRAM:		JRD Access Method
+ *	MODULE:			hash_group_test.sql
+ *	DESCRIPTION:	Tests for GROUP BY using a hash table
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ *
+ *  Run with: isql -q -i hash_group_test.sql
+ *
+ *  The script creates hash_group_test.fdb in the current directory and drops
+ *  it at the end. Each query grouped by a hash table (the plans printed first
+ *  show "Hash Aggregate") is compared with the same query whose groups have
+ *  to be ordered, which is done the old way, using a sort. A mismatch raises
+ *  an exception and stops the script, leaving the database for inspection.
+ */
+
+SET SQL DIALECT 3;
+SET BAIL ON;
+
+CREATE DATABASE 'hash_group_test.fdb' PAGE_SIZE 8192;
+
+CREATE EXCEPTION E_MISMATCH 'Mismatch in @1: hash @2, sort @3';
+
+CREATE TABLE T (
+	G INTEGER,
+	H INTEGER,
+	V INTEGER
+);
+
+CREATE TABLE F (
+	D DOUBLE PRECISION,
+	X DECFLOAT(34),
+	N NUMERIC(18, 4)
+);
+
+COMMIT;
+
+-- A few groups, NULL keys and values included
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 0;
+BEGIN
+	WHILE (I < 20000) DO
+	BEGIN
+		INSERT INTO T (G, H, V)
+			VALUES (IIF(MOD(:I, 97) = 0, NULL, MOD(:I, 50)), MOD(:I, 7), IIF(MOD(:I, 13) = 0, NULL, :I));
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+-- The indices give the estimation of the group count: it stays as low as
+-- computed here after the distinct keys are added below.
+
+CREATE INDEX T_G ON T (G);
+CREATE INDEX T_G_H ON T (G, H);
+CREATE INDEX F_D ON F (D);
+CREATE INDEX F_X ON F (X);
+CREATE INDEX F_N ON F (N);
+
+COMMIT;
+
+SET EXPLAIN ON;
+SET PLANONLY ON;
+
+SELECT G, COUNT(*) FROM T GROUP BY G;
+SELECT G, COUNT(*) FROM T GROUP BY G ORDER BY G;
+
+SET PLANONLY OFF;
+SET EXPLAIN OFF;
+
+SET TERM ^;
+
+CREATE PROCEDURE CHECK_T (STEP VARCHAR(30)) AS
+	DECLARE HASH_COUNT BIGINT;
+	DECLARE HASH_SUM BIGINT;
+	DECLARE SORT_COUNT BIGINT;
+	DECLARE SORT_SUM BIGINT;
+BEGIN
+	-- Compare the count of groups and the sum of row fingerprints
+
+	SELECT COUNT(*), SUM(MOD(HASH(COALESCE(G, -1) || ';' || CNT || ';' || CNT_V || ';' ||
+			COALESCE(SUM_V, -1) || ';' || COALESCE(MIN_V, -1) || ';' || COALESCE(MAX_V, -1) || ';' ||
+			COALESCE(AVG_V, -1)), 1000000007))
+		FROM (SELECT G, COUNT(*) CNT, COUNT(V) CNT_V, SUM(V) SUM_V, MIN(V) MIN_V, MAX(V) MAX_V,
+				AVG(V) AVG_V
+			FROM T GROUP BY G)
+		INTO HASH_COUNT, HASH_SUM;
+
+	SELECT COUNT(*), SUM(MOD(HASH(COALESCE(G, -1) || ';' || CNT || ';' || CNT_V || ';' ||
+			COALESCE(SUM_V, -1) || ';' || COALESCE(MIN_V, -1) || ';' || COALESCE(MAX_V, -1) || ';' ||
+			COALESCE(AVG_V, -1)), 1000000007))
+		FROM (SELECT G, COUNT(*) CNT, COUNT(V) CNT_V, SUM(V) SUM_V, MIN(V) MIN_V, MAX(V) MAX_V,
+				AVG(V) AVG_V
+			FROM T GROUP BY G ORDER BY G)
+		INTO SORT_COUNT, SORT_SUM;
+
+	IF (HASH_COUNT IS DISTINCT FROM SORT_COUNT OR HASH_SUM IS DISTINCT FROM SORT_SUM) THEN
+		EXCEPTION E_MISMATCH USING (STEP || ' (G)', HASH_COUNT || '/' || HASH_SUM,
+			SORT_COUNT || '/' || SORT_SUM);
+
+	-- Two keys
+
+	SELECT COUNT(*), SUM(MOD(HASH(COALESCE(G, -1) || ';' || H || ';' || CNT || ';' ||
+			COALESCE(SUM_V, -1)), 1000000007))
+		FROM (SELECT G, H, COUNT(*) CNT, SUM(V) SUM_V FROM T GROUP BY G, H)
+		INTO HASH_COUNT, HASH_SUM;
+
+	SELECT COUNT(*), SUM(MOD(HASH(COALESCE(G, -1) || ';' || H || ';' || CNT || ';' ||
+			COALESCE(SUM_V, -1)), 1000000007))
+		FROM (SELECT G, H, COUNT(*) CNT, SUM(V) SUM_V FROM T GROUP BY G, H ORDER BY G, H)
+		INTO SORT_COUNT, SORT_SUM;
+
+	IF (HASH_COUNT IS DISTINCT FROM SORT_COUNT OR HASH_SUM IS DISTINCT FROM SORT_SUM) THEN
+		EXCEPTION E_MISMATCH USING (STEP || ' (G, H)', HASH_COUNT || '/' || HASH_SUM,
+			SORT_COUNT || '/' || SORT_SUM);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+EXECUTE PROCEDURE CHECK_T ('few groups');
+
+-- Many more groups than estimated, these are spilled to the temporary space
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 0;
+BEGIN
+	WHILE (I < 400000) DO
+	BEGIN
+		INSERT INTO T (G, H, V) VALUES (:I + 1000, MOD(:I, 3), MOD(:I, 1000));
+		INSERT INTO T (G, H, V) VALUES (:I + 1000, MOD(:I, 5), NULL);
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+EXECUTE PROCEDURE CHECK_T ('many groups');
+
+-- Equal numbers of different representations make one group
+
+INSERT INTO F (D, X, N) VALUES (0e0, 1.0, 1.5);
+INSERT INTO F (D, X, N) VALUES (-0e0, 1.00, 1.50);
+INSERT INTO F (D, X, N) VALUES (0e0, 1, 1.5000);
+INSERT INTO F (D, X, N) VALUES (1e0, 100E-2, 2);
+INSERT INTO F (D, X, N) VALUES (NULL, NULL, NULL);
+
+COMMIT;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE HASH_COUNT BIGINT;
+	DECLARE SORT_COUNT BIGINT;
+BEGIN
+	SELECT COUNT(*) FROM (SELECT D FROM F GROUP BY D) INTO HASH_COUNT;
+	SELECT COUNT(*) FROM (SELECT D FROM F GROUP BY D ORDER BY D) INTO SORT_COUNT;
+
+	IF (HASH_COUNT <> 3 OR SORT_COUNT <> 3) THEN
+		EXCEPTION E_MISMATCH USING ('double zeros', HASH_COUNT, SORT_COUNT);
+
+	SELECT MAX(CNT) FROM (SELECT D, COUNT(*) CNT FROM F GROUP BY D) INTO HASH_COUNT;
+
+	IF (HASH_COUNT <> 3) THEN
+		EXCEPTION E_MISMATCH USING ('double zero count', HASH_COUNT, 3);
+
+	SELECT COUNT(*) FROM (SELECT X FROM F GROUP BY X) INTO HASH_COUNT;
+	SELECT COUNT(*) FROM (SELECT X FROM F GROUP BY X ORDER BY X) INTO SORT_COUNT;
+
+	IF (HASH_COUNT <> 2 OR SORT_COUNT <> 2) THEN
+		EXCEPTION E_MISMATCH USING ('decfloat scales', HASH_COUNT, SORT_COUNT);
+
+	SELECT COUNT(*) FROM (SELECT N FROM F GROUP BY N) INTO HASH_COUNT;
+	SELECT COUNT(*) FROM (SELECT N FROM F GROUP BY N ORDER BY N) INTO SORT_COUNT;
+
+	IF (HASH_COUNT <> 3 OR SORT_COUNT <> 3) THEN
+		EXCEPTION E_MISMATCH USING ('numeric', HASH_COUNT, SORT_COUNT);
+END^
+
+SET TERM ;^
+
+SELECT 'OK' AS RESULT FROM RDB$DATABASE;
+
+DROP DATABASE;
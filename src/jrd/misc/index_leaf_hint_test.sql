@@ -0,0 +1,233 @@
+/*
+ *	PROGRAM:		JRD Access Method
+ *	MODULE:			index_leaf_hint_test.sql
+ *	DESCRIPTION:	Tests for index inserts into the last used leaf page
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ *
+ *  Run with: isql -q -i index_leaf_hint_test.sql
+ *
+ *  Leaf hints are used by Superserver only, so run the script against it,
+ *  giving the credentials in ISC_USER and ISC_PASSWORD. The script creates
+ *  index_leaf_hint_test.fdb in the current directory and drops it at the
+ *  end. A second attachment to the same database, made by EXECUTE STATEMENT
+ *  ON EXTERNAL as the current user, drops and recreates the index between
+ *  the inserts of the first one.
+ *
+ *  After each step the keys found walking the index, and in a bitmap scan
+ *  of it, are compared with a natural scan of the table. A mismatch raises
+ *  an exception and stops the script, leaving the database for inspection.
+ */
+
+SET SQL DIALECT 3;
+SET BAIL ON;
+
+CREATE DATABASE 'index_leaf_hint_test.fdb' PAGE_SIZE 4096;
+
+CREATE EXCEPTION E_MISMATCH 'Mismatch after @1: @2';
+
+CREATE TABLE T (
+	K INTEGER NOT NULL,
+	FILLER CHAR(20)
+);
+
+CREATE INDEX T_K ON T (K);
+
+COMMIT;
+
+SET TERM ^;
+
+-- The index is used through dynamic statements, otherwise it can't be dropped
+
+CREATE PROCEDURE CHECK_T (STEP VARCHAR(40)) AS
+	DECLARE K INTEGER;
+	DECLARE PRIOR_K INTEGER;
+	DECLARE NAT_COUNT BIGINT;
+	DECLARE NAT_SUM BIGINT;
+	DECLARE IDX_COUNT BIGINT = 0;
+	DECLARE IDX_SUM BIGINT = 0;
+BEGIN
+	SELECT COUNT(*), COALESCE(SUM(K), 0) FROM T PLAN (T NATURAL) INTO NAT_COUNT, NAT_SUM;
+
+	FOR EXECUTE STATEMENT
+		'SELECT K FROM T WHERE K >= -2147483648 PLAN (T ORDER T_K) ORDER BY K'
+		INTO K
+	DO
+	BEGIN
+		IF (K < PRIOR_K) THEN
+			EXCEPTION E_MISMATCH USING (STEP, 'key ' || K || ' walked after ' || PRIOR_K);
+
+		PRIOR_K = K;
+		IDX_COUNT = IDX_COUNT + 1;
+		IDX_SUM = IDX_SUM + K;
+	END
+
+	IF (IDX_COUNT <> NAT_COUNT OR IDX_SUM <> NAT_SUM) THEN
+		EXCEPTION E_MISMATCH USING (STEP, 'index walk ' || IDX_COUNT || '/' || IDX_SUM ||
+			', natural ' || NAT_COUNT || '/' || NAT_SUM);
+
+	EXECUTE STATEMENT
+		'SELECT COUNT(*), COALESCE(SUM(K), 0) FROM T WHERE K >= -2147483648 PLAN (T INDEX (T_K))'
+		INTO IDX_COUNT, IDX_SUM;
+
+	IF (IDX_COUNT <> NAT_COUNT OR IDX_SUM <> NAT_SUM) THEN
+		EXCEPTION E_MISMATCH USING (STEP, 'index scan ' || IDX_COUNT || '/' || IDX_SUM ||
+			', natural ' || NAT_COUNT || '/' || NAT_SUM);
+END^
+
+CREATE PROCEDURE INSERT_RANGE (K_FROM INTEGER, K_TO INTEGER, K_STEP INTEGER) AS
+BEGIN
+	WHILE ((K_STEP > 0 AND K_FROM <= K_TO) OR (K_STEP < 0 AND K_FROM >= K_TO)) DO
+	BEGIN
+		INSERT INTO T (K, FILLER) VALUES (:K_FROM, :K_FROM);
+		K_FROM = K_FROM + K_STEP;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+-- Ordered keys, each one at the end of the last leaf page
+
+EXECUTE PROCEDURE INSERT_RANGE (2, 40000, 2);
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('ascending');
+
+-- Keys in reverse order, and in the middle of the index in no order at all
+
+EXECUTE PROCEDURE INSERT_RANGE (-2, -20000, -2);
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 0;
+BEGIN
+	WHILE (I < 20000) DO
+	BEGIN
+		INSERT INTO T (K) VALUES (MOD(:I * 7919, 20000) * 2 + 1);
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('out of order');
+
+-- Keys alternating between the end of the index and somewhere before it,
+-- duplicates included
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 0;
+BEGIN
+	WHILE (I < 20000) DO
+	BEGIN
+		INSERT INTO T (K) VALUES (40000 + :I);
+		INSERT INTO T (K) VALUES (MOD(:I, 500) * 80);
+		INSERT INTO T (K) VALUES (40000 + :I);
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('alternating');
+
+-- Leaf pages emptied and merged by the garbage collection
+
+DELETE FROM T WHERE K BETWEEN 45000 AND 59999;
+COMMIT;
+SELECT COUNT(*) FROM T WHERE K BETWEEN 45000 AND 59999;
+COMMIT;
+
+EXECUTE PROCEDURE INSERT_RANGE (60000, 70000, 1);
+EXECUTE PROCEDURE INSERT_RANGE (45000, 50000, 1);
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('garbage collection');
+
+-- The other attachment drops the index while ordered keys are inserted
+-- and recreates it, the new tree may reuse the pages of the old one
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE DB VARCHAR(255) = RDB$GET_CONTEXT('SYSTEM', 'DB_NAME');
+BEGIN
+	EXECUTE PROCEDURE INSERT_RANGE (100000, 105000, 1);
+	EXECUTE STATEMENT 'DROP INDEX T_K' WITH AUTONOMOUS TRANSACTION ON EXTERNAL :DB;
+	EXECUTE PROCEDURE INSERT_RANGE (110000, 115000, 1);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE DB VARCHAR(255) = RDB$GET_CONTEXT('SYSTEM', 'DB_NAME');
+BEGIN
+	EXECUTE STATEMENT 'CREATE INDEX T_K ON T (K)' WITH AUTONOMOUS TRANSACTION ON EXTERNAL :DB;
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+EXECUTE PROCEDURE INSERT_RANGE (200000, 210000, 1);
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('index recreated');
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE DB VARCHAR(255) = RDB$GET_CONTEXT('SYSTEM', 'DB_NAME');
+	DECLARE I INTEGER = 0;
+	DECLARE K INTEGER = 300000;
+BEGIN
+	-- The index can't be created while the relation has uncommitted changes
+	-- of another transaction, so the inserts are committed right away
+
+	WHILE (I < 3) DO
+	BEGIN
+		IN AUTONOMOUS TRANSACTION DO
+			EXECUTE PROCEDURE INSERT_RANGE (:K, :K + 5000, 1);
+
+		K = K + 10000;
+
+		EXECUTE STATEMENT 'DROP INDEX T_K' WITH AUTONOMOUS TRANSACTION ON EXTERNAL :DB;
+		EXECUTE STATEMENT 'CREATE INDEX T_K ON T (K)' WITH AUTONOMOUS TRANSACTION ON EXTERNAL :DB;
+
+		IN AUTONOMOUS TRANSACTION DO
+			EXECUTE PROCEDURE INSERT_RANGE (:K, :K + 5000, 1);
+
+		K = K + 10000;
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+EXECUTE PROCEDURE CHECK_T ('index dropped and recreated');
+
+SELECT 'OK' AS RESULT FROM RDB$DATABASE;
+
+DROP DATABASE;
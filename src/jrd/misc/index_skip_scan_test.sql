@@ -0,0 +1,175 @@
+/*
+ *	PROGRAM:		JRD Access Method
+ *	MODULE:			index_skip_scan_test.sql
+ *	DESCRIPTION:	Tests for skip scans of compound indices
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ *
+ *  Run with: isql -q -i index_skip_scan_test.sql
+ *
+ *  The script creates index_skip_scan_test.fdb in the current directory and
+ *  drops it at the end. Each condition on the second segment of a compound
+ *  index (the plans printed first show "Skip Scan") is checked against the
+ *  natural scan the table used to get. A mismatch raises an exception and
+ *  stops the script, leaving the database for inspection.
+ */
+
+SET SQL DIALECT 3;
+SET BAIL ON;
+
+CREATE DATABASE 'index_skip_scan_test.fdb' PAGE_SIZE 4096;
+
+CREATE EXCEPTION E_MISMATCH 'Mismatch for @1: index @2, natural @3';
+
+CREATE TABLE T (
+	A SMALLINT,
+	B INTEGER,
+	S VARCHAR(20)
+);
+
+COMMIT;
+
+-- A few leading values, NULL included, and NULLs in the second segment
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 0;
+BEGIN
+	WHILE (I < 100000) DO
+	BEGIN
+		INSERT INTO T (A, B, S)
+			VALUES (IIF(MOD(:I, 11) = 10, NULL, MOD(:I, 11)),
+					IIF(MOD(:I, 1009) = 0, NULL, :I / 3),
+					'K' || MOD(:I * 31, 20000));
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+CREATE INDEX T_A_B ON T (A, B);
+CREATE INDEX T_A_S ON T (A, S);
+
+COMMIT;
+
+SET EXPLAIN ON;
+SET PLANONLY ON;
+
+SELECT COUNT(*) FROM T WHERE B = 1000;
+SELECT COUNT(*) FROM T WHERE S STARTING WITH 'K123';
+
+SET PLANONLY OFF;
+SET EXPLAIN OFF;
+
+SET TERM ^;
+
+CREATE PROCEDURE CHECK_T (CONDITION VARCHAR(200)) AS
+	DECLARE IDX_COUNT BIGINT;
+	DECLARE IDX_SUM BIGINT;
+	DECLARE NAT_COUNT BIGINT;
+	DECLARE NAT_SUM BIGINT;
+BEGIN
+	EXECUTE STATEMENT
+		'SELECT COUNT(*), COALESCE(SUM(MOD(HASH(COALESCE(A, -1) || '';'' || COALESCE(B, -1) || '';'' || S), ' ||
+		'1000000007)), 0) ' ||
+		'FROM T WHERE ' || CONDITION
+		INTO IDX_COUNT, IDX_SUM;
+
+	EXECUTE STATEMENT
+		'SELECT COUNT(*), COALESCE(SUM(MOD(HASH(COALESCE(A, -1) || '';'' || COALESCE(B, -1) || '';'' || S), ' ||
+		'1000000007)), 0) ' ||
+		'FROM T WHERE ' || CONDITION || ' PLAN (T NATURAL)'
+		INTO NAT_COUNT, NAT_SUM;
+
+	IF (IDX_COUNT <> NAT_COUNT OR IDX_SUM <> NAT_SUM) THEN
+		EXCEPTION E_MISMATCH USING (CONDITION, IDX_COUNT || '/' || IDX_SUM, NAT_COUNT || '/' || NAT_SUM);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+EXECUTE PROCEDURE CHECK_T ('B = 1000');
+EXECUTE PROCEDURE CHECK_T ('B = 0');
+EXECUTE PROCEDURE CHECK_T ('B = 33333');
+EXECUTE PROCEDURE CHECK_T ('B = 40000');
+EXECUTE PROCEDURE CHECK_T ('B = -1');
+EXECUTE PROCEDURE CHECK_T ('B BETWEEN 100 AND 200');
+EXECUTE PROCEDURE CHECK_T ('B > 33000');
+EXECUTE PROCEDURE CHECK_T ('B >= 33333');
+EXECUTE PROCEDURE CHECK_T ('B < 10');
+EXECUTE PROCEDURE CHECK_T ('B <= 0');
+EXECUTE PROCEDURE CHECK_T ('B IS NULL');
+EXECUTE PROCEDURE CHECK_T ('B = 500 OR B = 700');
+EXECUTE PROCEDURE CHECK_T ('B IN (1, 2, 3, 20000)');
+EXECUTE PROCEDURE CHECK_T ('B = 1000 AND A IS NULL');
+EXECUTE PROCEDURE CHECK_T ('B = 1000 AND A > 5');
+EXECUTE PROCEDURE CHECK_T ('B > 1000 AND B < 1100 AND S > ''K5''');
+EXECUTE PROCEDURE CHECK_T ('S = ''K500''');
+EXECUTE PROCEDURE CHECK_T ('S STARTING WITH ''K123''');
+EXECUTE PROCEDURE CHECK_T ('S STARTING WITH ''''');
+EXECUTE PROCEDURE CHECK_T ('S STARTING WITH ''Z''');
+EXECUTE PROCEDURE CHECK_T ('S BETWEEN ''K1'' AND ''K2''');
+EXECUTE PROCEDURE CHECK_T ('S > ''K9'' AND B < 5000');
+
+-- Skip scans of an index which is also used for navigation
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE KA SMALLINT;
+	DECLARE KB INTEGER;
+	DECLARE PRIOR_A SMALLINT;
+	DECLARE IDX_COUNT BIGINT = 0;
+	DECLARE NAT_COUNT BIGINT;
+BEGIN
+	FOR SELECT A, B FROM T WHERE B BETWEEN 100 AND 200 AND A IS NOT NULL ORDER BY A INTO KA, KB DO
+	BEGIN
+		IF (KA < PRIOR_A OR KB < 100 OR KB > 200) THEN
+			EXCEPTION E_MISMATCH USING ('navigation', KA || '/' || KB, PRIOR_A);
+
+		PRIOR_A = KA;
+		IDX_COUNT = IDX_COUNT + 1;
+	END
+
+	SELECT COUNT(*) FROM T WHERE B BETWEEN 100 AND 200 AND A IS NOT NULL PLAN (T NATURAL)
+		INTO NAT_COUNT;
+
+	IF (IDX_COUNT <> NAT_COUNT) THEN
+		EXCEPTION E_MISMATCH USING ('navigation', IDX_COUNT, NAT_COUNT);
+END^
+
+SET TERM ;^
+
+-- Leading values added and removed after the statistics were computed
+
+DELETE FROM T WHERE A = 3;
+INSERT INTO T (A, B, S) VALUES (100, 1000, 'K500');
+INSERT INTO T (A, B, S) VALUES (-100, 1000, 'K500');
+INSERT INTO T (A, B, S) VALUES (NULL, 1000, 'K500');
+COMMIT;
+
+EXECUTE PROCEDURE CHECK_T ('B = 1000');
+EXECUTE PROCEDURE CHECK_T ('B BETWEEN 999 AND 1001');
+EXECUTE PROCEDURE CHECK_T ('S = ''K500''');
+EXECUTE PROCEDURE CHECK_T ('S STARTING WITH ''K50''');
+
+SELECT 'OK' AS RESULT FROM RDB$DATABASE;
+
+DROP DATABASE;
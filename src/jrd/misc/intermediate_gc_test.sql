@@ -0,0 +1,218 @@
+/*
+ *	PROGRAM:		JRD Access Method
+ *	MODULE:			intermediate_gc_test.sql
+ *	DESCRIPTION:	Tests for garbage collection of intermediate record versions
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ *
+ *  Run with: isql -q -i intermediate_gc_test.sql
+ *
+ *  Intermediate versions are purged by the garbage collector thread of
+ *  Superserver only, so run the script against it with GCPolicy set to
+ *  background or combined, giving the credentials in ISC_USER and
+ *  ISC_PASSWORD. The script creates intermediate_gc_test.fdb in the current
+ *  directory and drops it at the end. A second attachment, made by EXECUTE
+ *  STATEMENT ON EXTERNAL as the current user, keeps a snapshot taken in the
+ *  middle of the updates.
+ *
+ *  While the records are updated by other transactions and the garbage
+ *  collector is given time to work, the snapshots must keep reading the
+ *  same data. A mismatch raises an exception and stops the script, leaving
+ *  the database for inspection.
+ */
+
+SET SQL DIALECT 3;
+SET BAIL ON;
+
+CREATE DATABASE 'intermediate_gc_test.fdb' PAGE_SIZE 4096;
+
+CREATE EXCEPTION E_MISMATCH 'Mismatch in @1: read @2, expected @3';
+
+CREATE TABLE T (
+	ID INTEGER NOT NULL PRIMARY KEY,
+	V INTEGER,
+	FILLER VARCHAR(100)
+);
+
+COMMIT;
+
+SET TERM ^;
+
+-- Update every record in a transaction of its own
+
+CREATE PROCEDURE UPDATE_ALL (DELTA INTEGER) AS
+BEGIN
+	IN AUTONOMOUS TRANSACTION DO
+		UPDATE T SET V = V + :DELTA, FILLER = LPAD('', MOD(V, 100), 'X');
+END^
+
+-- Read the records from a new transaction for a while, letting the
+-- garbage collector purge what the readers found, and check the sums of
+-- the snapshot of the calling transaction and the one of the other
+-- attachment on each pass
+
+CREATE PROCEDURE WAIT_GC (STEP VARCHAR(40), DURATION INTEGER, OWN_SUM BIGINT, OTHER_SUM BIGINT) AS
+	DECLARE DB VARCHAR(255);
+	DECLARE FINISH TIMESTAMP;
+	DECLARE N BIGINT;
+BEGIN
+	DB = RDB$GET_CONTEXT('SYSTEM', 'DB_NAME');
+	FINISH = DATEADD(DURATION SECOND TO CAST('NOW' AS TIMESTAMP));
+
+	WHILE (CAST('NOW' AS TIMESTAMP) < FINISH) DO
+	BEGIN
+		IN AUTONOMOUS TRANSACTION DO
+			SELECT COUNT(*) FROM T WHERE FILLER >= '' INTO N;
+
+		SELECT SUM(V) FROM T INTO N;
+
+		IF (N <> OWN_SUM) THEN
+			EXCEPTION E_MISMATCH USING (STEP || ', own snapshot', N, OWN_SUM);
+
+		IF (OTHER_SUM IS NOT NULL) THEN
+		BEGIN
+			EXECUTE STATEMENT 'SELECT SUM(V) FROM T' ON EXTERNAL :DB INTO N;
+
+			IF (N <> OTHER_SUM) THEN
+				EXCEPTION E_MISMATCH USING (STEP || ', other snapshot', N, OTHER_SUM);
+		END
+	END
+END^
+
+EXECUTE BLOCK AS
+	DECLARE I INTEGER = 1;
+BEGIN
+	WHILE (I <= 1000) DO
+	BEGIN
+		INSERT INTO T (ID, V, FILLER) VALUES (:I, 0, '');
+		I = I + 1;
+	END
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+-- The snapshot of this transaction sees the records before any update,
+-- the one of the other attachment sees them after the second one. The
+-- versions of the other updates are seen by nobody.
+
+SET TRANSACTION SNAPSHOT;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE DB VARCHAR(255);
+	DECLARE OWN_SUM BIGINT;
+	DECLARE OTHER_SUM BIGINT;
+BEGIN
+	DB = RDB$GET_CONTEXT('SYSTEM', 'DB_NAME');
+
+	SELECT SUM(V) FROM T INTO OWN_SUM;
+
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+
+	-- The common transaction of the other attachment lasts as long as ours
+
+	EXECUTE STATEMENT 'SELECT SUM(V) FROM T' ON EXTERNAL :DB INTO OTHER_SUM;
+
+	IF (OTHER_SUM <> 2000) THEN
+		EXCEPTION E_MISMATCH USING ('other snapshot', OTHER_SUM, 2000);
+
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+
+	EXECUTE PROCEDURE WAIT_GC ('snapshots', 5, OWN_SUM, OTHER_SUM);
+
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE WAIT_GC ('snapshots, more updates', 3, OWN_SUM, OTHER_SUM);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE N BIGINT;
+BEGIN
+	SELECT SUM(V) FROM T INTO N;
+
+	IF (N <> 6000) THEN
+		EXCEPTION E_MISMATCH USING ('updates', N, 6000);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+-- Changes committed with the context retained are seen by the snapshot,
+-- although they are written under a transaction number above it
+
+SET TRANSACTION SNAPSHOT;
+
+UPDATE T SET V = 100 WHERE ID <= 10;
+COMMIT RETAIN;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE OWN_SUM BIGINT;
+BEGIN
+	SELECT SUM(V) FROM T INTO OWN_SUM;
+
+	IF (OWN_SUM <> 6000 - 10 * 6 + 10 * 100) THEN
+		EXCEPTION E_MISMATCH USING ('retained', OWN_SUM, 6000 - 10 * 6 + 10 * 100);
+
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+
+	EXECUTE PROCEDURE WAIT_GC ('retained', 5, OWN_SUM, NULL);
+END^
+
+SET TERM ;^
+
+-- Retaining the context once more changes the transaction number again
+
+COMMIT RETAIN;
+
+SET TERM ^;
+
+EXECUTE BLOCK AS
+	DECLARE OWN_SUM BIGINT;
+BEGIN
+	SELECT SUM(V) FROM T INTO OWN_SUM;
+
+	IF (OWN_SUM <> 6000 - 10 * 6 + 10 * 100) THEN
+		EXCEPTION E_MISMATCH USING ('retained twice', OWN_SUM, 6000 - 10 * 6 + 10 * 100);
+
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+	EXECUTE PROCEDURE UPDATE_ALL (1);
+
+	EXECUTE PROCEDURE WAIT_GC ('retained twice', 5, OWN_SUM, NULL);
+END^
+
+SET TERM ;^
+
+COMMIT;
+
+SELECT 'OK' AS RESULT FROM RDB$DATABASE;
+
+DROP DATABASE;
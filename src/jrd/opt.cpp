@@ -294,6 +294,7 @@ static SLONG decompose(thread_db* tdbb, BoolExprNode* boolNode, BoolExprNodeStac
 	CompilerScratch* csb);
 static USHORT distribute_equalities(BoolExprNodeStack& org_stack, CompilerScratch* csb,
 	USHORT base_count);
+static double estimate_groups(const CompilerScratch*, const SortNode*);
 static void find_index_relationship_streams(thread_db* tdbb, OptimizerBlk* opt,
 	const StreamList& streams, StreamList& dependent_streams, StreamList& free_streams);
 static void form_rivers(thread_db* tdbb, OptimizerBlk* opt, const StreamList& streams,
@@ -369,6 +370,9 @@ inline bool TEST_DEP_ARRAYS(const ULONG* ar1, const ULONG* ar2)
 
 const int CACHE_PAGES_PER_STREAM			= 15;
 
+// the largest estimated number of groups for hash grouping
+const double MAX_HASH_GROUPS				= 1000;
+
 // enumeration of sort datatypes
 
 static const UCHAR sort_dtypes[] =
@@ -460,6 +464,7 @@ RecordSource* OPT_compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
 	opt->opt_streams.grow(csb->csb_n_stream);
 	opt->optimizeFirstRows = (rse->flags & RseNode::FLAG_OPT_FIRST_ROWS) != 0;
 	RecordSource* rsb = NULL;
+	SortedStream* sortRsb = NULL;
 
 	try {
 
@@ -782,6 +787,21 @@ RecordSource* OPT_compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
 	for (StreamType i = 0; i < opt->compileStreams.getCount(); i++)
 		check_indices(&csb->csb_rpt[opt->compileStreams[i]]);
 
+	// A GROUP BY that is not served by the index navigation may be done using
+	// a hash table rather than a sort, if the expected number of groups is known
+	// and small. Should the estimation be wrong, the surplus groups are spilled.
+	if (rse->flags & RseNode::FLAG_HASH_GROUPING)
+	{
+		const double groups = (sort && sort == rse->rse_sorted && !project &&
+			!rse->rse_first && !rse->rse_skip) ? estimate_groups(csb, sort) : 0;
+
+		if (groups <= 0 || groups > MAX_HASH_GROUPS)
+			rse->flags &= ~RseNode::FLAG_HASH_GROUPING;
+	}
+
+	if (rse->flags & RseNode::FLAG_HASH_GROUPING)
+		sort = NULL;
+
 	if (project || sort)
 	{
 		// CVC: I'm not sure how to do this with Array in a clearer way.
@@ -808,7 +828,7 @@ RecordSource* OPT_compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = OPT_gen_sort(tdbb, opt->opt_csb, opt->beds, &opt->keyStreams, rsb, sort, false);
+			rsb = sortRsb = OPT_gen_sort(tdbb, opt->opt_csb, opt->beds, &opt->keyStreams, rsb, sort, false);
 	}
 
     // Handle first and/or skip.  The skip MUST (if present)
@@ -816,11 +836,23 @@ RecordSource* OPT_compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
     // functions add their nodes at the beginning of the rsb list we MUST call
     // gen_skip before gen_first.
 
+	SkipRowsStream* skipRsb = NULL;
+
     if (rse->rse_skip)
-		rsb = FB_NEW_POOL(*pool) SkipRowsStream(csb, rsb, rse->rse_skip);
+		rsb = skipRsb = FB_NEW_POOL(*pool) SkipRowsStream(csb, rsb, rse->rse_skip);
 
 	if (rse->rse_first)
-		rsb = FB_NEW_POOL(*pool) FirstRowsStream(csb, rsb, rse->rse_first);
+	{
+		FirstRowsStream* const firstRsb = FB_NEW_POOL(*pool) FirstRowsStream(csb, rsb, rse->rse_first);
+
+		// If FIRST is applied to the sorted output, let the sort keep only
+		// the records to be returned. The counts are evaluated once by the
+		// FIRST/SKIP streams and read back by the sort when it is opened.
+		if (sortRsb)
+			sortRsb->setLimit(firstRsb, skipRsb);
+
+		rsb = firstRsb;
+	}
 
 	if (rse->flags & RseNode::FLAG_WRITELOCK)
 	{
@@ -1059,6 +1091,7 @@ static void check_sorts(CompilerScratch* csb, RseNode* rse)
 			{
 				set_direction(project, group);
 				project = rse->rse_projection = NULL;
+				static_cast<AggregateSourceNode*>(sub_rse)->orderedGroups = true;
 			}
 		}
 
@@ -1095,6 +1128,7 @@ static void check_sorts(CompilerScratch* csb, RseNode* rse)
 				set_direction(sort, group);
 				set_position(sort, group, static_cast<AggregateSourceNode*>(sub_rse)->map);
 				sort = rse->rse_sorted = NULL;
+				static_cast<AggregateSourceNode*>(sub_rse)->orderedGroups = true;
 			}
 		}
 
@@ -1637,6 +1671,84 @@ static USHORT distribute_equalities(BoolExprNodeStack& org_stack, CompilerScratc
 }
 
 
+static double estimate_groups(const CompilerScratch* csb, const SortNode* sort)
+{
+/**************************************
+ *
+ *	e s t i m a t e _ g r o u p s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the number of distinct values of the
+ *	sort keys, using the segment selectivities of
+ *	the indices defined on exactly those fields.
+ *	Return zero if no estimation is possible.
+ *
+ **************************************/
+	StreamList streams;
+
+	for (const NestConst<ValueExprNode>* ptr = sort->expressions.begin();
+		 ptr != sort->expressions.end(); ++ptr)
+	{
+		const FieldNode* const field = nodeAs<FieldNode>(*ptr);
+
+		if (!field)
+			return 0;
+
+		if (!streams.exist(field->fieldStream))
+			streams.add(field->fieldStream);
+	}
+
+	double groups = 1;
+
+	for (const StreamType* stream = streams.begin(); stream != streams.end(); ++stream)
+	{
+		const CompilerScratch::csb_repeat* const tail = &csb->csb_rpt[*stream];
+
+		if (!tail->csb_idx)
+			return 0;
+
+		SortedArray<USHORT> fields;
+
+		for (const NestConst<ValueExprNode>* ptr = sort->expressions.begin();
+			 ptr != sort->expressions.end(); ++ptr)
+		{
+			const FieldNode* const field = nodeAs<FieldNode>(*ptr);
+
+			if (field->fieldStream == *stream && !fields.exist(field->fieldId))
+				fields.add(field->fieldId);
+		}
+
+		const FB_SIZE_T count = fields.getCount();
+		double distinctValues = 0;
+
+		const index_desc* idx = tail->csb_idx->items;
+		for (USHORT i = 0; i < tail->csb_indices; i++, idx++)
+		{
+			if ((idx->idx_flags & idx_expressn) || idx->idx_count < count)
+				continue;
+
+			USHORT segment = 0;
+			while (segment < count && fields.exist(idx->idx_rpt[segment].idx_field))
+				segment++;
+
+			const float selectivity = idx->idx_rpt[count - 1].idx_selectivity;
+
+			if (segment == count && selectivity > 0)
+				distinctValues = MAX(distinctValues, 1 / selectivity);
+		}
+
+		if (!distinctValues)
+			return 0;
+
+		groups *= distinctValues;
+	}
+
+	return groups;
+}
+
+
 static void find_index_relationship_streams(thread_db* tdbb,
 											OptimizerBlk* opt,
 											const StreamList& streams,
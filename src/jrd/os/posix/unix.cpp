@@ -174,6 +174,52 @@ int PIO_add_file(thread_db* tdbb, jrd_file* main_file, const PathName& file_name
 }
 
 
+void PIO_advise_read(const Database* dbb, jrd_file* main_file, const ULONG* pages, USHORT count)
+{
+/**************************************
+ *
+ *	P I O _ a d v i s e _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Tell the kernel that the given pages are going
+ *	to be read soon, so it may start reading them in
+ *	background. Adjacent pages are advised together.
+ *
+ **************************************/
+#ifdef HAVE_POSIX_FADVISE
+	const ULONG pageSize = dbb->dbb_page_size;
+
+	while (count)
+	{
+		const ULONG first = *pages;
+		ULONG last = first;
+
+		while (--count && *++pages == last + 1)
+			last++;
+
+		jrd_file* file = main_file;
+
+		while (file && !(first >= file->fil_min_page && last <= file->fil_max_page))
+			file = file->fil_next;
+
+		if (!file || file->fil_desc == -1 || (file->fil_flags & FIL_no_fs_cache))
+			continue;
+
+		FB_UINT64 offset = first - file->fil_min_page + file->fil_fudge;
+		offset *= pageSize;
+
+		if (offset != (FB_UINT64) LSEEK_OFFSET_CAST offset)
+			continue;
+
+		os_utils::posix_fadvise(file->fil_desc, LSEEK_OFFSET_CAST offset,
+			(last - first + 1) * pageSize, POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+
 void PIO_close(jrd_file* main_file)
 {
 /**************************************
@@ -322,6 +322,23 @@ void PIO_extend(thread_db* tdbb, jrd_file* main_file, const ULONG extPages, cons
 }
 
 
+void PIO_advise_read(const Database* /*dbb*/, jrd_file* /*main_file*/,
+	const ULONG* /*pages*/, USHORT /*count*/)
+{
+/**************************************
+ *
+ *	P I O _ a d v i s e _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read-ahead hint. Windows has no per-range advice
+ *	for the file cache, so there is nothing to do here.
+ *
+ **************************************/
+}
+
+
 void PIO_flush(thread_db* tdbb, jrd_file* main_file)
 {
 /**************************************
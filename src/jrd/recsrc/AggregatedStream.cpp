@@ -356,11 +356,34 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, jrd_re
 		return m_next->getRecord(tdbb);
 }
 
-// Export the template for WindowedStream::WindowStream.
+// Export the template for WindowedStream::WindowStream and HashAggregate.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
+template class Jrd::BaseAggWinStream<HashAggregate, RecordSource>;
 
 // ------------------------------
 
+// Consumer accumulating the aggregates over the whole input stream
+
+class AggregatedStream::TotalsConsumer : public RecordConsumer
+{
+public:
+	TotalsConsumer(const AggregatedStream* stream, jrd_req* request)
+		: m_stream(stream), m_request(request)
+	{
+	}
+
+	bool process(thread_db* tdbb)
+	{
+		const MapNode* const map = m_stream->m_groupMap;
+		return m_stream->aggPass(tdbb, m_request, map->sourceList, map->targetList);
+	}
+
+private:
+	const AggregatedStream* const m_stream;
+	jrd_req* const m_request;
+};
+
+
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next)
 	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
@@ -391,7 +414,7 @@ bool AggregatedStream::getRecord(thread_db* tdbb) const
 		return false;
 	}
 
-	if (!evaluateGroup(tdbb))
+	if (!(m_group ? evaluateGroup(tdbb) : evaluateTotals(tdbb)))
 	{
 		rpb->rpb_number.setValid(false);
 		return false;
@@ -400,3 +423,35 @@ bool AggregatedStream::getRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+// Compute the aggregates without GROUP BY. There are no group boundaries to
+// look for, so the input stream pushes its records here in a single batch.
+bool AggregatedStream::evaluateTotals(thread_db* tdbb) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	fb_assert(!m_group && m_oneRowWhenEmpty);
+
+	if (impure->state == STATE_EOF)
+		return false;
+
+	impure->state = STATE_EOF;
+
+	try
+	{
+		aggInit(tdbb, request, m_groupMap);
+
+		TotalsConsumer consumer(this, request);
+		m_next->getRecords(tdbb, consumer);
+
+		aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+	}
+	catch (const Exception&)
+	{
+		aggFinish(tdbb, request, m_groupMap);
+		throw;
+	}
+
+	return true;
+}
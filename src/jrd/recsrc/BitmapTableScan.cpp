@@ -22,6 +22,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/req.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
@@ -53,6 +54,7 @@ void BitmapTableScan::open(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 	impure->irsb_bitmap = EVL_bitmap(tdbb, m_inversion, NULL);
+	impure->irsb_prefetch_number = -1;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
@@ -110,6 +112,26 @@ bool BitmapTableScan::getRecord(thread_db* tdbb) const
 		{
 			rpb->rpb_number.setValue(bitmap->current());
 
+			// Read ahead the data pages of the next records, unless they all
+			// seem to fit the first data page (e.g. a unique index lookup)
+
+			const SINT64 number = rpb->rpb_number.getValue();
+
+			if (impure->irsb_prefetch_number < 0)
+			{
+				const ULONG maxRecords = tdbb->getDatabase()->dbb_max_records;
+				impure->irsb_prefetch_number = (number / maxRecords + 1) * maxRecords;
+			}
+			else if (number >= impure->irsb_prefetch_number)
+			{
+				impure->irsb_prefetch_number =
+					DPM_prefetch_bitmap(tdbb, m_relation, bitmap, number);
+			}
+
+			// Index nodes carry no transaction numbers and may outlive the records
+			// they point to, so the record is always fetched to prove it's visible.
+			// Its data is not copied if nobody is going to read it (RPB_s_no_data).
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
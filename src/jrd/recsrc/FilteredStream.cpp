@@ -35,6 +35,31 @@ using namespace Jrd;
 // Data access: predicate driven filter
 // ------------------------------------
 
+// Consumer passing through the records matching the boolean
+
+class FilteredStream::Filter : public RecordConsumer
+{
+public:
+	Filter(jrd_req* request, const BoolExprNode* boolean, RecordConsumer& consumer)
+		: m_request(request), m_boolean(boolean), m_consumer(consumer)
+	{
+	}
+
+	bool process(thread_db* tdbb)
+	{
+		if (!m_boolean->execute(tdbb, m_request))
+			return true;
+
+		return m_consumer.process(tdbb);
+	}
+
+private:
+	jrd_req* const m_request;
+	const BoolExprNode* const m_boolean;
+	RecordConsumer& m_consumer;
+};
+
+
 FilteredStream::FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean)
 	: m_next(next), m_boolean(boolean), m_anyBoolean(NULL),
 	  m_ansiAny(false), m_ansiAll(false), m_ansiNot(false)
@@ -90,6 +115,29 @@ bool FilteredStream::getRecord(thread_db* tdbb) const
 	return true;
 }
 
+bool FilteredStream::getRecords(thread_db* tdbb, RecordConsumer& consumer) const
+{
+	// ANY/ALL processing looks at the whole substream per record, so it's done the usual way
+	if (m_anyBoolean)
+		return RecordSource::getRecords(tdbb, consumer);
+
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return false;
+
+	Filter filter(request, m_boolean, consumer);
+
+	if (!m_next->getRecords(tdbb, filter))
+	{
+		invalidateRecords(request);
+		return false;
+	}
+
+	return true;
+}
+
 bool FilteredStream::refetchRecord(thread_db* tdbb) const
 {
 	jrd_req* const request = tdbb->getRequest();
@@ -81,6 +81,16 @@ void FirstRowsStream::close(thread_db* tdbb) const
 	}
 }
 
+SINT64 FirstRowsStream::getCount(jrd_req* request) const
+{
+	// Number of records still to be returned. Right after open() this is
+	// the evaluated FIRST value.
+
+	const Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	return (impure->irsb_flags & irsb_open) ? impure->irsb_count : 0;
+}
+
 bool FirstRowsStream::getRecord(thread_db* tdbb) const
 {
 	if (--tdbb->tdbb_quantum < 0)
@@ -129,6 +129,39 @@ bool FullTableScan::getRecord(thread_db* tdbb) const
 	return false;
 }
 
+bool FullTableScan::getRecords(thread_db* tdbb, RecordConsumer& consumer) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	// Walk the data pages in a tight loop, handing over every record
+	// to the consumer instead of returning it through the callers
+
+	while (true)
+	{
+		if (--tdbb->tdbb_quantum < 0)
+			JRD_reschedule(tdbb, 0, true);
+
+		if (!VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, false))
+			break;
+
+		rpb->rpb_number.setValid(true);
+
+		if (!consumer.process(tdbb))
+			return true;
+	}
+
+	rpb->rpb_number.setValid(false);
+	return false;
+}
+
 void FullTableScan::print(thread_db* tdbb, string& plan, bool detailed, unsigned level) const
 {
 	if (detailed)
@@ -0,0 +1,847 @@
+/*
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/Hash.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/intl.h"
+#include "../jrd/TempSpace.h"
+#include "../dsql/Nodes.h"
+#include "../dsql/ExprNodes.h"
+#include "../jrd/cmp_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/exe_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/intl_proto.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// ---------------------------------
+// Data access: hash-based grouping
+// ---------------------------------
+
+static const FB_SIZE_T HASH_INITIAL_SLOTS = 64;	// must be a power of two
+
+// Once the groups occupy that much memory, the records of the groups that
+// are not in the hash table yet are spilled into the partitions of the temporary
+// space and aggregated later, one partition at a time
+static const ULONG HASH_MEMORY_LIMIT = 8 * 1024 * 1024;
+
+static const unsigned HASH_PARTITION_BITS = 4;
+static const unsigned HASH_PARTITIONS = 1 << HASH_PARTITION_BITS;
+
+// The partitions of the deepest level are aggregated regardless of the limit
+static const USHORT HASH_MAX_LEVEL = 4;
+
+static const FB_SIZE_T NOT_SPILLED = ~FB_SIZE_T(0);
+
+static const char* const SCRATCH = "fb_hash_agg_";
+
+static bool getValue(const UCHAR*, FB_SIZE_T&, dsc*);
+static void putValue(UCharBuffer&, const dsc*);
+
+struct HashAggregate::Group
+{
+	Group* next;				// next group in the same hash slot
+	ULONG hash;
+	impure_value* keys;			// values of the grouping expressions
+	impure_value* values;		// values of the non-aggregate map sources
+	impure_value_ex* states;	// saved states of the aggregate map sources
+};
+
+struct HashAggregate::Partition
+{
+	TempSpace* space;			// spilled records, NULL if there are none
+	USHORT level;				// level of the hash table to be built from them
+};
+
+class HashAggregate::HashTable : public PermanentStorage
+{
+public:
+	HashTable(MemoryPool& pool, FB_SIZE_T keyCount, FB_SIZE_T mapCount)
+		: PermanentStorage(pool),
+		  m_keyCount(keyCount),
+		  m_mapCount(mapCount),
+		  m_groups(pool),
+		  m_slots(pool)
+	{
+		m_slots.grow(HASH_INITIAL_SLOTS);
+	}
+
+	~HashTable()
+	{
+		for (Group** iter = m_groups.begin(); iter != m_groups.end(); ++iter)
+		{
+			Group* const group = *iter;
+
+			for (FB_SIZE_T i = 0; i < m_keyCount + m_mapCount; i++)
+				delete group->keys[i].vlu_string;
+
+			for (FB_SIZE_T i = 0; i < m_mapCount; i++)
+				delete group->states[i].vlu_string;
+
+			delete[] group->keys;
+			delete[] group->states;
+			delete group;
+		}
+	}
+
+	Group* lookup(ULONG hash) const
+	{
+		return m_slots[hash & (m_slots.getCount() - 1)];
+	}
+
+	Group* add(ULONG hash)
+	{
+		// Keep the load factor below one
+		if (m_groups.getCount() >= m_slots.getCount())
+			rehash(m_slots.getCount() * 2);
+
+		MemoryPool& pool = getPool();
+
+		Group* const group = FB_NEW_POOL(pool) Group;
+		group->hash = hash;
+
+		// Value-initialize, so the values and states start cleared
+		group->keys = FB_NEW_POOL(pool) impure_value[m_keyCount + m_mapCount]();
+		group->values = group->keys + m_keyCount;
+
+		group->states = FB_NEW_POOL(pool) impure_value_ex[m_mapCount]();
+
+		Group*& slot = m_slots[hash & (m_slots.getCount() - 1)];
+		group->next = slot;
+		slot = group;
+
+		m_groups.add(group);
+		return group;
+	}
+
+	FB_SIZE_T getCount() const
+	{
+		return m_groups.getCount();
+	}
+
+	bool isFull(FB_SIZE_T maxGroups) const
+	{
+		return m_groups.getCount() >= maxGroups;
+	}
+
+	Group* get(FB_SIZE_T position) const
+	{
+		return m_groups[position];
+	}
+
+private:
+	void rehash(FB_SIZE_T slotCount)
+	{
+		m_slots.clear();
+		m_slots.grow(slotCount);
+
+		for (Group** iter = m_groups.begin(); iter != m_groups.end(); ++iter)
+		{
+			Group* const group = *iter;
+			Group*& slot = m_slots[group->hash & (slotCount - 1)];
+			group->next = slot;
+			slot = group;
+		}
+	}
+
+	const FB_SIZE_T m_keyCount;
+	const FB_SIZE_T m_mapCount;
+	Array<Group*> m_groups;		// groups in order of their appearance
+	Array<Group*> m_slots;
+};
+
+
+HashAggregate::HashAggregate(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, false, next),
+	  m_keyLengths(csb->csb_pool),
+	  m_totalKeyLength(0),
+	  m_maxGroups(0)
+{
+	fb_assert(group && map);
+	fb_assert(isSupported(map));
+
+	for (NestConst<ValueExprNode>* ptr = group->begin(); ptr != group->end(); ++ptr)
+	{
+		dsc desc;
+		(*ptr)->getDesc(tdbb, csb, &desc);
+
+		USHORT keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+		if (IS_INTL_DATA(&desc))
+			keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
+		else if (desc.isNumeric() || desc.isDecFloat() || desc.isDecFixed())
+			keyLength = MAX(keyLength, Decimal128::getIndexKeyLength());
+
+		m_keyLengths.add(keyLength);
+		m_totalKeyLength += keyLength;
+	}
+
+	// Approximate memory used by a single group, the key length stands for its strings
+	const FB_SIZE_T mapCount = map->sourceList.getCount();
+	const FB_SIZE_T groupSize = sizeof(Group) + 2 * sizeof(Group*) + m_totalKeyLength +
+		(group->getCount() + mapCount) * sizeof(impure_value) + mapCount * sizeof(impure_value_ex);
+
+	m_maxGroups = MAX(HASH_MEMORY_LIMIT / groupSize, 1);
+}
+
+// Check whether all the aggregates of the map may keep their state in a hash table.
+bool HashAggregate::isSupported(const MapNode* map)
+{
+	for (const NestConst<ValueExprNode>* source = map->sourceList.begin();
+		 source != map->sourceList.end();
+		 ++source)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+		if (aggNode && (aggNode->distinct ||
+			!(aggNode->getCapabilities() & AggNode::CAP_SUPPORTS_HASH_GROUPING)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void HashAggregate::open(thread_db* tdbb) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	freeGroups(request, impure);
+	freePartitions(impure);
+	impure->irsb_position = 0;
+
+	BaseAggWinStream::open(tdbb);
+}
+
+void HashAggregate::close(thread_db* tdbb) const
+{
+	jrd_req* const request = tdbb->getRequest();
+	Impure* const impure = getImpure(request);
+
+	freeGroups(request, impure);
+	freePartitions(impure);
+
+	BaseAggWinStream::close(tdbb);
+}
+
+void HashAggregate::print(thread_db* tdbb, string& plan, bool detailed, unsigned level) const
+{
+	if (detailed)
+		plan += printIndent(++level) + "Hash Aggregate";
+
+	m_next->print(tdbb, plan, detailed, level);
+}
+
+bool HashAggregate::getRecord(thread_db* tdbb) const
+{
+	if (--tdbb->tdbb_quantum < 0)
+		JRD_reschedule(tdbb, 0, true);
+
+	jrd_req* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = getImpure(request);
+
+	if (!(impure->irsb_flags & irsb_open) || impure->state == STATE_EOF)
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	if (impure->state == STATE_GROUPING)
+	{
+		// Read the whole input stream and aggregate it into the hash table
+
+		buildGroups(tdbb, request, impure);
+		impure->state = STATE_FETCHED;
+	}
+
+	// Once the hash table is exhausted, aggregate the spilled records, if any
+
+	while (impure->irsb_position >= impure->irsb_hash_table->getCount())
+	{
+		if (!buildSpilledGroups(tdbb, request, impure))
+		{
+			impure->state = STATE_EOF;
+			rpb->rpb_number.setValid(false);
+			return false;
+		}
+	}
+
+	HashTable* const hashTable = impure->irsb_hash_table;
+
+	const Group* const group = hashTable->get(impure->irsb_position++);
+
+	restoreState(request, group);
+
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+	const NestValueArray& targetList = m_groupMap->targetList;
+
+	for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+	{
+		const ValueExprNode* const source = sourceList[i];
+		const ValueExprNode* const target = targetList[i];
+
+		if (nodeIs<AggNode>(source))
+			continue;
+
+		if (nodeIs<LiteralNode>(source))
+		{
+			EXE_assignment(tdbb, source, target);
+			continue;
+		}
+
+		const FieldNode* const field = nodeAs<FieldNode>(target);
+		const USHORT id = field->fieldId;
+		Record* const record = request->req_rpb[field->fieldStream].rpb_record;
+		const impure_value* const value = &group->values[i];
+
+		if (!value->vlu_desc.dsc_address)
+			record->setNull(id);
+		else
+		{
+			MOV_move(tdbb, const_cast<dsc*>(&value->vlu_desc), EVL_assign_to(tdbb, target));
+			record->clearNull(id);
+		}
+	}
+
+	aggExecute(tdbb, request, sourceList, targetList);
+
+	rpb->rpb_number.setValid(true);
+	return true;
+}
+
+void HashAggregate::buildGroups(thread_db* tdbb, jrd_req* request, Impure* impure) const
+{
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	HashTable* const hashTable = impure->irsb_hash_table =
+		FB_NEW_POOL(pool) HashTable(pool, m_group->getCount(), m_groupMap->sourceList.getCount());
+
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+	UCharBuffer keyBuffer(pool);
+	UCHAR* const keyPtr = keyBuffer.getBuffer(m_totalKeyLength, false);
+	UCharBuffer row(pool);
+	FB_SIZE_T base = NOT_SPILLED;
+
+	Group* current = NULL;
+
+	try
+	{
+		while (m_next->getRecord(tdbb))
+		{
+			cacheValues(tdbb, request, m_group, impure->groupValues, DummyAdjustFunctor());
+
+			const ULONG hash = computeHash(tdbb, impure->groupValues, keyPtr);
+
+			Group* group = findGroup(tdbb, hashTable, impure->groupValues, hash);
+
+			if (!group && hashTable->isFull(m_maxGroups))
+			{
+				// No room for a new group: put the record aside
+				makeRow(tdbb, request, impure->groupValues, row);
+				spillRow(tdbb, impure, 0, base, hash, row.begin(), row.getCount());
+				continue;
+			}
+
+			if (!group)
+			{
+				// The first record of a new group: remember its non-aggregate values
+
+				if (current)
+					saveState(request, current);
+
+				current = group = addGroup(tdbb, request, hashTable, impure->groupValues, hash);
+
+				for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+				{
+					const ValueExprNode* const source = sourceList[i];
+
+					if (!nodeIs<AggNode>(source) && !nodeIs<LiteralNode>(source))
+					{
+						dsc* const desc = EVL_expr(tdbb, request, source);
+
+						if (!(request->req_flags & req_null))
+							EVL_make_value(tdbb, desc, &group->values[i]);
+					}
+				}
+			}
+			else if (group != current)
+			{
+				saveState(request, current);
+				restoreState(request, group);
+				current = group;
+			}
+
+			for (const NestConst<ValueExprNode>* source = sourceList.begin();
+				 source != sourceList.end();
+				 ++source)
+			{
+				const AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+				if (aggNode)
+					aggNode->aggPass(tdbb, request);
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		if (current)
+			saveState(request, current);
+		throw;
+	}
+
+	if (current)
+		saveState(request, current);
+}
+
+// Replace the exhausted hash table with the one built from the records of the last
+// spilled partition. Returns false if there are no spilled records left.
+bool HashAggregate::buildSpilledGroups(thread_db* tdbb, jrd_req* request, Impure* impure) const
+{
+	Array<Partition>* const partitions = impure->irsb_partitions;
+
+	while (partitions && partitions->hasData() && !partitions->back().space)
+		partitions->pop();
+
+	if (!partitions || partitions->isEmpty())
+		return false;
+
+	// Keep the partition in the list until it's read, so it's released on errors
+	const FB_SIZE_T index = partitions->getCount() - 1;
+	const Partition partition = (*partitions)[index];
+
+	freeGroups(request, impure);
+	impure->irsb_position = 0;
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	HashTable* const hashTable = impure->irsb_hash_table =
+		FB_NEW_POOL(pool) HashTable(pool, m_group->getCount(), m_groupMap->sourceList.getCount());
+
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+	Array<UCHAR> row(pool);
+	FB_SIZE_T base = NOT_SPILLED;
+
+	Group* current = NULL;
+
+	try
+	{
+		const offset_t end = partition.space->getSize();
+
+		for (offset_t position = 0; position < end;)
+		{
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, 0, true);
+
+			// The record is its length and hash followed by the values, see makeRow()
+			ULONG header[2];
+			partition.space->read(position, header, sizeof(header));
+			position += sizeof(header);
+
+			const ULONG length = header[0];
+			const ULONG hash = header[1];
+
+			UCHAR* const data = row.getBuffer(length, false);
+			partition.space->read(position, data, length);
+			position += length;
+
+			FB_SIZE_T offset = 0;
+
+			for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+			{
+				dsc desc;
+
+				if (getValue(data, offset, &desc))
+					EVL_make_value(tdbb, &desc, &impure->groupValues[i]);
+				else
+					impure->groupValues[i].vlu_desc.dsc_address = NULL;
+			}
+
+			const FB_SIZE_T sourceOffset = offset;
+
+			Group* group = findGroup(tdbb, hashTable, impure->groupValues, hash);
+
+			if (!group && partition.level < HASH_MAX_LEVEL && hashTable->isFull(m_maxGroups))
+			{
+				spillRow(tdbb, impure, partition.level, base, hash, data, length);
+				continue;
+			}
+
+			if (!group)
+			{
+				if (current)
+					saveState(request, current);
+
+				current = group = addGroup(tdbb, request, hashTable, impure->groupValues, hash);
+
+				for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+				{
+					const ValueExprNode* const source = sourceList[i];
+					dsc desc;
+
+					if (getValue(data, offset, &desc) && !nodeIs<AggNode>(source))
+						EVL_make_value(tdbb, &desc, &group->values[i]);
+				}
+			}
+			else if (group != current)
+			{
+				saveState(request, current);
+				restoreState(request, group);
+				current = group;
+			}
+
+			offset = sourceOffset;
+
+			for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+			{
+				const AggNode* const aggNode = nodeAs<AggNode>(sourceList[i]);
+				dsc desc;
+				const bool hasValue = getValue(data, offset, &desc);
+
+				// A NULL argument is ignored, as AggNode::aggPass() does
+				if (aggNode && (hasValue || !aggNode->arg))
+					aggNode->aggPass(tdbb, request, hasValue ? &desc : NULL);
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		if (current)
+			saveState(request, current);
+		throw;
+	}
+
+	if (current)
+		saveState(request, current);
+
+	delete partition.space;
+	partitions->remove(index);
+
+	return true;
+}
+
+// Add a new group for the cached group values and start its aggregates from scratch.
+HashAggregate::Group* HashAggregate::addGroup(thread_db* tdbb, jrd_req* request,
+	HashTable* hashTable, const impure_value* values, ULONG hash) const
+{
+	Group* const group = hashTable->add(hash);
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		const impure_value* const from = &values[i];
+
+		if (from->vlu_desc.dsc_address)
+			EVL_make_value(tdbb, &from->vlu_desc, &group->keys[i]);
+	}
+
+	for (const NestConst<ValueExprNode>* source = m_groupMap->sourceList.begin();
+		 source != m_groupMap->sourceList.end();
+		 ++source)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+		if (aggNode)
+		{
+			// The string of the live impure area is owned by the previous group
+			request->getImpure<impure_value_ex>(aggNode->impureOffset)->vlu_string = NULL;
+			aggNode->aggInit(tdbb, request);
+		}
+	}
+
+	return group;
+}
+
+// Find the group the cached group values belong to.
+HashAggregate::Group* HashAggregate::findGroup(thread_db* tdbb, const HashTable* hashTable,
+	const impure_value* values, ULONG hash) const
+{
+	Group* group = hashTable->lookup(hash);
+
+	while (group && (group->hash != hash || !compareKeys(tdbb, values, group)))
+		group = group->next;
+
+	return group;
+}
+
+// Release the groups together with the values they own.
+void HashAggregate::freeGroups(jrd_req* request, Impure* impure) const
+{
+	if (!impure->irsb_hash_table)
+		return;
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = NULL;
+
+	// The aggregate impure areas may still refer to strings owned by the groups
+	for (const NestConst<ValueExprNode>* source = m_groupMap->sourceList.begin();
+		 source != m_groupMap->sourceList.end();
+		 ++source)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(*source);
+
+		if (aggNode)
+			request->getImpure<impure_value_ex>(aggNode->impureOffset)->vlu_string = NULL;
+	}
+}
+
+// Release the spilled records.
+void HashAggregate::freePartitions(Impure* impure) const
+{
+	if (!impure->irsb_partitions)
+		return;
+
+	for (Partition* iter = impure->irsb_partitions->begin(); iter != impure->irsb_partitions->end(); ++iter)
+		delete iter->space;
+
+	delete impure->irsb_partitions;
+	impure->irsb_partitions = NULL;
+}
+
+// Store the cached group values, the non-aggregate map sources and the arguments
+// of the aggregates of the current record, to aggregate it later.
+void HashAggregate::makeRow(thread_db* tdbb, jrd_req* request, const impure_value* values,
+	UCharBuffer& row) const
+{
+	row.clear();
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+		putValue(row, values[i].vlu_desc.dsc_address ? &values[i].vlu_desc : NULL);
+
+	for (const NestConst<ValueExprNode>* source = m_groupMap->sourceList.begin();
+		 source != m_groupMap->sourceList.end();
+		 ++source)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(*source);
+		const ValueExprNode* expr = *source;
+
+		if (aggNode)
+			expr = aggNode->arg;
+		else if (nodeIs<LiteralNode>(expr))
+			expr = NULL;
+
+		const dsc* desc = expr ? EVL_expr(tdbb, request, expr) : NULL;
+
+		if (expr && (request->req_flags & req_null))
+			desc = NULL;
+
+		putValue(row, desc);
+	}
+}
+
+// Append the record to the partition of the next level it belongs to. The partitions
+// of a hash table are allocated on its first spilled record, starting at the base index.
+void HashAggregate::spillRow(thread_db* tdbb, Impure* impure, USHORT level, FB_SIZE_T& base,
+	ULONG hash, const UCHAR* row, ULONG length) const
+{
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	if (!impure->irsb_partitions)
+		impure->irsb_partitions = FB_NEW_POOL(pool) Array<Partition>(pool);
+
+	Array<Partition>& partitions = *impure->irsb_partitions;
+
+	if (base == NOT_SPILLED)
+	{
+		base = partitions.getCount();
+
+		Partition partition;
+		partition.space = NULL;
+		partition.level = level + 1;
+
+		for (unsigned i = 0; i < HASH_PARTITIONS; i++)
+			partitions.add(partition);
+	}
+
+	// The lower bits of the hash select the slots, so use the upper ones here
+	const unsigned shift = 32 - HASH_PARTITION_BITS * (level + 1);
+	Partition& partition = partitions[base + ((hash >> shift) & (HASH_PARTITIONS - 1))];
+
+	if (!partition.space)
+		partition.space = FB_NEW_POOL(pool) TempSpace(pool, SCRATCH);
+
+	const ULONG header[2] = {length, hash};
+	const offset_t position = partition.space->getSize();
+
+	partition.space->write(position, header, sizeof(header));
+	partition.space->write(position + sizeof(header), row, length);
+}
+
+// Hash the cached group values, the same way HashJoin does for its keys.
+ULONG HashAggregate::computeHash(thread_db* tdbb, const impure_value* values,
+	UCHAR* keyBuffer) const
+{
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_keyLengths.getCount(); i++)
+	{
+		const dsc* const desc = &values[i].vlu_desc;
+		const USHORT keyLength = m_keyLengths[i];
+
+		if (desc->dsc_address)
+		{
+			if (desc->isNumeric() || desc->isDecFloat() || desc->isDecFixed())
+			{
+				// Numbers that compare equal must hash equally regardless of their type and
+				// scale, or the sign of zero, so hash their normalized decimal index key
+				VaryStr<sizeof(Decimal128) * 2> key;
+				Decimal128 dec = MOV_get_dec128(tdbb, desc);
+				const ULONG length = dec.makeIndexKey(&key);
+
+				fb_assert(length <= keyLength);
+				memcpy(keyPtr, key.vary_string, length);
+				memset(keyPtr + length, 0, keyLength - length);
+			}
+			else if (desc->isText())
+			{
+				dsc to;
+				to.makeText(keyLength, desc->getTextType(), keyPtr);
+
+				if (IS_INTL_DATA(desc))
+				{
+					// Convert the INTL string into the binary comparable form
+					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
+									   desc, &to, INTL_KEY_UNIQUE);
+				}
+				else
+				{
+					// This call ensures that the padding bytes are appended
+					MOV_move(tdbb, const_cast<dsc*>(desc), &to);
+				}
+			}
+			else
+			{
+				const USHORT length = MIN(keyLength, desc->dsc_length);
+				memcpy(keyPtr, desc->dsc_address, length);
+				memset(keyPtr + length, 0, keyLength - length);
+			}
+		}
+		else
+		{
+			memset(keyPtr, 0, keyLength);
+		}
+
+		keyPtr += keyLength;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_totalKeyLength);
+
+	return InternalHash::hash(m_totalKeyLength, keyBuffer);
+}
+
+// Check whether the cached group values belong to the given group. NULLs are equal here.
+bool HashAggregate::compareKeys(thread_db* tdbb, const impure_value* values,
+	const Group* group) const
+{
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		const dsc* const desc1 = &values[i].vlu_desc;
+		const dsc* const desc2 = &group->keys[i].vlu_desc;
+
+		if (!desc1->dsc_address || !desc2->dsc_address)
+		{
+			if (desc1->dsc_address || desc2->dsc_address)
+				return false;
+		}
+		else if (MOV_compare(tdbb, desc1, desc2) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+// Move the states of the aggregates from their impure areas into the group.
+void HashAggregate::saveState(jrd_req* request, Group* group) const
+{
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+
+	for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(sourceList[i]);
+
+		if (aggNode)
+		{
+			group->states[i] = *request->getImpure<impure_value_ex>(aggNode->impureOffset);
+		}
+	}
+}
+
+// Move the states of the aggregates from the group into their impure areas.
+void HashAggregate::restoreState(jrd_req* request, const Group* group) const
+{
+	const NestValueArray& sourceList = m_groupMap->sourceList;
+
+	for (FB_SIZE_T i = 0; i < sourceList.getCount(); i++)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(sourceList[i]);
+
+		if (aggNode)
+		{
+			*request->getImpure<impure_value_ex>(aggNode->impureOffset) = group->states[i];
+		}
+	}
+}
+
+// Read a value stored by putValue(), returns false for NULL.
+static bool getValue(const UCHAR* row, FB_SIZE_T& offset, dsc* desc)
+{
+	offset = FB_ALIGN(offset, FB_DOUBLE_ALIGN);
+	memcpy(desc, row + offset, sizeof(dsc));
+	offset = FB_ALIGN(offset + sizeof(dsc), FB_DOUBLE_ALIGN);
+
+	if (desc->isUnknown())
+		return false;
+
+	desc->dsc_address = const_cast<UCHAR*>(row) + offset;
+	offset += desc->dsc_length;
+
+	return true;
+}
+
+// Append the descriptor and the data of a value to the row, NULL is stored
+// as the unknown data type. The data is aligned for any data type.
+static void putValue(UCharBuffer& row, const dsc* desc)
+{
+	dsc header;
+
+	if (desc)
+		header = *desc;
+	else
+		header.clear();
+
+	header.dsc_address = NULL;
+
+	const FB_SIZE_T offset = FB_ALIGN(row.getCount(), FB_DOUBLE_ALIGN);
+	const FB_SIZE_T dataOffset = FB_ALIGN(offset + sizeof(dsc), FB_DOUBLE_ALIGN);
+
+	row.resize(dataOffset + header.dsc_length, 0);
+
+	memcpy(row.begin() + offset, &header, sizeof(dsc));
+
+	if (desc)
+		memcpy(row.begin() + dataOffset, desc->dsc_address, desc->dsc_length);
+}
@@ -143,7 +143,8 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 				const bool partial = (retrieval->irb_generic & irb_partial);
 
 				const bool fullscan = (maxSegs == 0);
-				const bool unique = uniqueIdx && equality && (minSegs == segCount);
+				const bool skip = (retrieval->irb_generic & irb_skip_scan);
+				const bool unique = uniqueIdx && equality && !skip && (minSegs == segCount);
 
 				string bounds;
 				if (!unique && !fullscan)
@@ -177,7 +178,7 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 				}
 
 				plan += "Index " + printName(tdbb, indexName.c_str()) +
-					(fullscan ? " Full" : unique ? " Unique" : " Range") + " Scan" + bounds;
+					(fullscan ? " Full" : unique ? " Unique" : skip ? " Skip" : " Range") + " Scan" + bounds;
 			}
 			else
 			{
@@ -195,6 +196,20 @@ RecordSource::~RecordSource()
 {
 }
 
+// Push the records of the stream to the consumer until either the end of the
+// stream is reached or the consumer stops the fetch. Returns false at EOF.
+// The default implementation just pulls the records one by one.
+bool RecordSource::getRecords(thread_db* tdbb, RecordConsumer& consumer) const
+{
+	while (getRecord(tdbb))
+	{
+		if (!consumer.process(tdbb))
+			return true;
+	}
+
+	return false;
+}
+
 
 // RecordStream class
 // ------------------
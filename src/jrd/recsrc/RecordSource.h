@@ -52,6 +52,18 @@ namespace Jrd
 
 	enum JoinType { INNER_JOIN, OUTER_JOIN, SEMI_JOIN, ANTI_JOIN };
 
+	// Receiver of the records pushed by RecordSource::getRecords()
+
+	class RecordConsumer
+	{
+	public:
+		// Process the current record of the stream, return false to stop fetching
+		virtual bool process(thread_db* tdbb) = 0;
+
+	protected:
+		~RecordConsumer() {}
+	};
+
 	// Abstract base class
 
 	class RecordSource
@@ -61,6 +73,7 @@ namespace Jrd
 		virtual void close(thread_db* tdbb) const = 0;
 
 		virtual bool getRecord(thread_db* tdbb) const = 0;
+		virtual bool getRecords(thread_db* tdbb, RecordConsumer& consumer) const;
 		virtual bool refetchRecord(thread_db* tdbb) const = 0;
 		virtual bool lockRecord(thread_db* tdbb) const = 0;
 
@@ -153,6 +166,7 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 
 		bool getRecord(thread_db* tdbb) const override;
+		bool getRecords(thread_db* tdbb, RecordConsumer& consumer) const override;
 
 		void print(thread_db* tdbb, Firebird::string& plan,
 				   bool detailed, unsigned level) const override;
@@ -167,6 +181,7 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			RecordBitmap** irsb_bitmap;
+			SINT64 irsb_prefetch_number;
 		};
 
 	public:
@@ -415,6 +430,8 @@ namespace Jrd
 			m_next->setAnyBoolean(anyBoolean, ansiAny, ansiNot);
 		}
 
+		SINT64 getCount(jrd_req* request) const;
+
 	private:
 		NestConst<RecordSource> m_next;
 		NestConst<ValueExprNode> const m_value;
@@ -451,6 +468,8 @@ namespace Jrd
 			m_next->setAnyBoolean(anyBoolean, ansiAny, ansiNot);
 		}
 
+		SINT64 getCount(jrd_req* request) const;
+
 	private:
 		NestConst<RecordSource> m_next;
 		NestConst<ValueExprNode> const m_value;
@@ -458,6 +477,8 @@ namespace Jrd
 
 	class FilteredStream : public RecordSource
 	{
+		class Filter;
+
 	public:
 		FilteredStream(CompilerScratch* csb, RecordSource* next, BoolExprNode* boolean);
 
@@ -465,6 +486,7 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 
 		bool getRecord(thread_db* tdbb) const override;
+		bool getRecords(thread_db* tdbb, RecordConsumer& consumer) const override;
 		bool refetchRecord(thread_db* tdbb) const override;
 		bool lockRecord(thread_db* tdbb) const override;
 
@@ -591,11 +613,20 @@ namespace Jrd
 		UCHAR* getData(thread_db* tdbb) const;
 		void mapData(thread_db* tdbb, jrd_req* request, UCHAR* data) const;
 
+		void setLimit(const FirstRowsStream* first, const SkipRowsStream* skip)
+		{
+			m_first = first;
+			m_skip = skip;
+		}
+
 	private:
 		Sort* init(thread_db* tdbb) const;
+		FB_UINT64 getLimit(thread_db* tdbb) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		const FirstRowsStream* m_first;
+		const SkipRowsStream* m_skip;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -756,6 +787,8 @@ namespace Jrd
 
 	class AggregatedStream : public BaseAggWinStream<AggregatedStream, RecordSource>
 	{
+		class TotalsConsumer;
+
 	public:
 		AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next);
@@ -763,6 +796,65 @@ namespace Jrd
 	public:
 		void print(thread_db* tdbb, Firebird::string& plan, bool detailed, unsigned level) const;
 		bool getRecord(thread_db* tdbb) const;
+
+	private:
+		bool evaluateTotals(thread_db* tdbb) const;
+	};
+
+	class HashAggregate : public BaseAggWinStream<HashAggregate, RecordSource>
+	{
+		class HashTable;
+		struct Group;
+		struct Partition;
+
+	public:
+		struct Impure : public BaseAggWinStream::Impure
+		{
+			HashTable* irsb_hash_table;
+			FB_SIZE_T irsb_position;
+			Firebird::Array<Partition>* irsb_partitions;
+		};
+
+	public:
+		HashAggregate(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+			NestValueArray* group, MapNode* map, RecordSource* next);
+
+		static bool isSupported(const MapNode* map);
+
+	public:
+		void open(thread_db* tdbb) const override;
+		void close(thread_db* tdbb) const override;
+
+		void print(thread_db* tdbb, Firebird::string& plan, bool detailed, unsigned level) const override;
+		bool getRecord(thread_db* tdbb) const override;
+
+	protected:
+		Impure* getImpure(jrd_req* request) const
+		{
+			return request->getImpure<Impure>(m_impure);
+		}
+
+	private:
+		void buildGroups(thread_db* tdbb, jrd_req* request, Impure* impure) const;
+		bool buildSpilledGroups(thread_db* tdbb, jrd_req* request, Impure* impure) const;
+		Group* addGroup(thread_db* tdbb, jrd_req* request, HashTable* hashTable,
+			const impure_value* values, ULONG hash) const;
+		Group* findGroup(thread_db* tdbb, const HashTable* hashTable,
+			const impure_value* values, ULONG hash) const;
+		void freeGroups(jrd_req* request, Impure* impure) const;
+		void freePartitions(Impure* impure) const;
+		void makeRow(thread_db* tdbb, jrd_req* request, const impure_value* values,
+			Firebird::UCharBuffer& row) const;
+		void spillRow(thread_db* tdbb, Impure* impure, USHORT level, FB_SIZE_T& base,
+			ULONG hash, const UCHAR* row, ULONG length) const;
+		ULONG computeHash(thread_db* tdbb, const impure_value* values, UCHAR* keyBuffer) const;
+		bool compareKeys(thread_db* tdbb, const impure_value* values, const Group* group) const;
+		void saveState(jrd_req* request, Group* group) const;
+		void restoreState(jrd_req* request, const Group* group) const;
+
+		Firebird::Array<ULONG> m_keyLengths;
+		ULONG m_totalKeyLength;
+		FB_SIZE_T m_maxGroups;
 	};
 
 	class WindowedStream : public RecordSource
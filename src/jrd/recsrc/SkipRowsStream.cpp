@@ -80,6 +80,16 @@ void SkipRowsStream::close(thread_db* tdbb) const
 	}
 }
 
+SINT64 SkipRowsStream::getCount(jrd_req* request) const
+{
+	// Number of records still to be skipped. Right after open() this is
+	// the evaluated SKIP value.
+
+	const Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	return (impure->irsb_flags & irsb_open) ? impure->irsb_count - 1 : 0;
+}
+
 bool SkipRowsStream::getRecord(thread_db* tdbb) const
 {
 	if (--tdbb->tdbb_quantum < 0)
@@ -40,7 +40,7 @@ using namespace Jrd;
 // -----------------------------
 
 SortedStream::SortedStream(CompilerScratch* csb, RecordSource* next, SortMap* map)
-	: m_next(next), m_map(map)
+	: m_next(next), m_map(map), m_first(NULL), m_skip(NULL)
 {
 	fb_assert(m_next && m_map);
 
@@ -169,7 +169,8 @@ Sort* SortedStream::init(thread_db* tdbb) const
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : NULL), 0));
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : NULL), 0,
+			 getLimit(tdbb)));
 
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
@@ -263,6 +264,31 @@ Sort* SortedStream::init(thread_db* tdbb) const
 	return scb.release();
 }
 
+FB_UINT64 SortedStream::getLimit(thread_db* tdbb) const
+{
+	// If FIRST/SKIP is applied directly to the sort output, the caller is
+	// never going to fetch more than FIRST + SKIP records. Zero means no limit.
+	// The counts are taken from the outer streams that have already evaluated
+	// them while being opened.
+
+	if (!m_first)
+		return 0;
+
+	jrd_req* const request = tdbb->getRequest();
+
+	const SINT64 first = m_first->getCount(request);
+
+	if (first <= 0)
+		return 0;
+
+	const SINT64 skip = m_skip ? m_skip->getCount(request) : 0;
+
+	if (skip < 0 || skip > MAX_SINT64 - first)
+		return 0;
+
+	return (FB_UINT64) (first + skip);
+}
+
 bool SortedStream::compareKeys(const UCHAR* p, const UCHAR* q) const
 {
 	if (!memcmp(p, q, m_map->keyLength))
@@ -85,6 +85,10 @@ void SortOwner::unlinkAll()
 const ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 const ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Upper limit of the sort buffer used by the bounded (top-N) sort.
+// If the requested records don't fit there, a regular sort is performed.
+const ULONG MAX_TOP_N_BUFFER_SIZE = 1024 * 1024 * 4;	// 4MB
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -184,6 +188,11 @@ Sort::Sort(Database* dbb,
  *		  compared. This is used at creation of unique index since sort key
  *		  includes index key (which must be unique) and record numbers.
  *
+ * If max_records is not zero, the caller is going to fetch no more than
+ * that number of records. If they fit into a single sort buffer, the sort
+ * keeps only the first max_records records in a bounded heap and never
+ * writes runs to the scratch file.
+ *
  **************************************/
 	fb_assert(owner);
 	fb_assert(unique_keys <= keys);
@@ -206,6 +215,23 @@ Sort::Sort(Database* dbb,
 		m_dup_callback_arg = user_arg;
 		m_max_records = max_records;
 
+		// Bounded sort needs room for max_records + 1 records and their pointers,
+		// plus the low key, the high key and one spare pointer slot
+
+		ULONG top_n_size = 0;
+
+		if (m_max_records && !m_dup_callback &&
+			m_max_records < MAX_TOP_N_BUFFER_SIZE / (record_size + sizeof(sort_record*)))
+		{
+			top_n_size = (ULONG) ((m_max_records + 1) * record_size +
+				(m_max_records + 4) * sizeof(sort_record*));
+
+			if (top_n_size > MAX_TOP_N_BUFFER_SIZE)
+				top_n_size = 0;
+			else if (top_n_size > m_max_alloc_size)
+				m_max_alloc_size = top_n_size;
+		}
+
 		for (FB_SIZE_T i = 0; i < keys; i++)
 		{
 			m_description.add(key_description[i]);
@@ -227,6 +253,9 @@ Sort::Sort(Database* dbb,
 
 		allocateBuffer(pool);
 
+		if (top_n_size && m_size_memory >= top_n_size)
+			m_flags |= scb_top_n;
+
 		m_end_memory = m_memory + m_size_memory;
 		m_first_pointer = (sort_record**) m_memory;
 
@@ -375,19 +404,30 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		// by unsigned longword compares
 
 		SR* record = m_last_record;
+		SR* free_record = NULL;
 
 		if (record != (SR*) m_end_memory)
 		{
 			diddleKey((UCHAR*) (record->sr_sort_record.sort_record_key), true);
+
+			if (m_flags & scb_top_n)
+				free_record = putTopN();
 		}
 
+		if (free_record)
+		{
+			// Bounded sort: reuse the space of the record just pushed out
+			record = free_record;
+		}
 		// If there isn't room for the record, sort and write the run.
 		// Check that we are not at the beginning of the buffer in addition
 		// to checking for space for the record. This avoids the pointer
 		// record from underflowing in the second condition.
-		if ((UCHAR*) record < m_memory + m_longs ||
+		else if ((UCHAR*) record < m_memory + m_longs ||
 			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
 		{
+			fb_assert(!(m_flags & scb_top_n));
+
 			putRun(tdbb);
 			while (true)
 			{
@@ -403,10 +443,10 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 				mergeRuns(count);
 			}
 			init();
-			record = m_last_record;
+			record = NEXT_RECORD(m_last_record);
 		}
-
-		record = NEXT_RECORD(record);
+		else
+			record = NEXT_RECORD(record);
 
 		// Make sure the first longword of the record points to the pointer
 		m_last_record = record;
@@ -450,6 +490,9 @@ void Sort::sort(thread_db* tdbb)
 		if (m_last_record != (SR*) m_end_memory)
 		{
 			diddleKey((UCHAR*) KEYOF(m_last_record), true);
+
+			if (m_flags & scb_top_n)
+				putTopN();
 		}
 
 		// If there aren't any runs, things fit nicely in memory. Just sort the mess
@@ -2113,3 +2156,88 @@ void Sort::sortRunsBySeek(int n)
 	}
 	run->run_next = tail;
 }
+
+
+int Sort::compareKeys(const SORTP* p, const SORTP* q) const
+{
+/**************************************
+ *
+ * Compare the (diddled) keys of two records.
+ *
+ **************************************/
+	for (ULONG l = m_key_length; l; l--, p++, q++)
+	{
+		if (*p != *q)
+			return (*p > *q) ? 1 : -1;
+	}
+
+	return 0;
+}
+
+
+SR* Sort::putTopN()
+{
+/**************************************
+ *
+ * Bounded sort: the record pointers are kept as a max-heap of
+ * no more than m_max_records entries, the greatest key on top.
+ * The record just stored by the caller is the last pointer.
+ * While the heap isn't full, just sift the new record up.
+ * Otherwise, either the new record replaces the top one or it's
+ * not among the first m_max_records records at all. In both cases
+ * the loser is dropped and its space is returned to be reused
+ * for the next record.
+ *
+ **************************************/
+	SORTP** const heap = reinterpret_cast<SORTP**>(m_first_pointer + 1);
+	const ULONG count = reinterpret_cast<SORTP**>(m_next_pointer) - heap;
+
+	fb_assert(count && count <= m_max_records + 1);
+
+	if (count <= m_max_records)
+	{
+		for (ULONG child = count - 1; child; )
+		{
+			const ULONG parent = (child - 1) / 2;
+
+			if (compareKeys(heap[parent], heap[child]) >= 0)
+				break;
+
+			swap(heap + parent, heap + child);
+			child = parent;
+		}
+
+		return NULL;
+	}
+
+	SORTP** const last = heap + m_max_records;
+
+	if (compareKeys(*last, *heap) < 0)
+	{
+		swap(heap, last);
+
+		for (ULONG parent = 0; ; )
+		{
+			ULONG largest = parent;
+			const ULONG left = 2 * parent + 1;
+			const ULONG right = left + 1;
+
+			if (left < m_max_records && compareKeys(heap[left], heap[largest]) > 0)
+				largest = left;
+
+			if (right < m_max_records && compareKeys(heap[right], heap[largest]) > 0)
+				largest = right;
+
+			if (largest == parent)
+				break;
+
+			swap(heap + parent, heap + largest);
+			parent = largest;
+		}
+	}
+
+	m_next_pointer--;
+	m_records--;
+
+	return reinterpret_cast<SR*>(*last - SIZEOF_SR_BCKPTR_IN_LONGS);
+}
@@ -286,6 +286,8 @@ private:
 	void putRun(Jrd::thread_db*);
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
+	SR* putTopN();
+	int compareKeys(const SORTP*, const SORTP*) const;
 
 #ifdef DEV_BUILD
 	void checkFile(const run_control*);
@@ -305,7 +307,7 @@ private:
 	ULONG m_key_length;							// Key length
 	ULONG m_unique_length;						// Unique key length, used when duplicates eliminated
 	FB_UINT64 m_records;						// Number of records
-	FB_UINT64 m_max_records;					// Maximum number of records to store, assigned but unused.
+	FB_UINT64 m_max_records;					// Maximum number of records to return, zero if unbounded
 	TempSpace* m_space;							// temporary space for scratch file
 	run_control* m_runs;						// ALLOC: Run on scratch file, if any
 	merge_control* m_merge;						// Top level merge block
@@ -324,6 +326,7 @@ private:
 // flags as set in m_flags
 
 const int scb_sorted = 1;	// stream has been sorted
+const int scb_top_n = 2;	// bounded sort, only first m_max_records are kept
 
 class SortOwner
 {
@@ -31,15 +31,206 @@
 #include "../jrd/ods_proto.h"
 #include "../jrd/tpc_proto.h"
 #include "../jrd/tra_proto.h"
+#include "../common/file_params.h"
+#include "../common/isc_proto.h"
+#include "../common/isc_s_proto.h"
+#include "../common/utils_proto.h"
+#include "../common/os/guid.h"
 
 
 using namespace Firebird;
 
 namespace Jrd {
 
+// When the Database object is private to the process (Classic) or to the
+// attachment (SuperClassic) every copy of the TIP cache used to learn about
+// commits and rollbacks made elsewhere only by re-reading the TIP pages.
+// The states of each TIP page are therefore also kept in a shared memory
+// block, one mapped file per TIP page. Every process copies the TIP page
+// into the block when it reads the page and records the state changes it
+// makes, so the other processes find them without any page I/O.
+//
+// A block may lag behind the TIP page but never runs ahead of it: TIP page
+// images are copied while the page is latched and the state changes are
+// recorded after the TIP page is written. The only possible staleness is a
+// transaction still shown as active (or limbo), which is always verified
+// against the transaction lock by the callers.
+//
+// Every process using the blocks holds a shared LCK_tpc_init lock. The first
+// one to take it puts a new random stamp into the lock data, so the stamp
+// lives exactly as long as there are processes with the database open. A
+// block carrying another stamp was left by processes which are gone (maybe
+// crashed, never decrementing tsb_users), and is initialized again.
+
+struct StatusBlockHeader : public MemoryHeader
+{
+	SINT64 tsb_stamp;			// generation of processes using the block
+	ULONG tsb_users;			// processes which have the block mapped
+	ULONG tsb_loaded;			// states were copied from the TIP page
+	ULONG tsb_retired;			// file is unlinked, map it again
+	UCHAR tsb_transactions[1];	// two bits per transaction
+};
+
+class TipCache::StatusBlock FB_FINAL : public IpcObject
+{
+public:
+	static const USHORT STATUS_BLOCK_VERSION = 2;
+
+	StatusBlock(Database* dbb, TraNumber base, SINT64 stamp)
+		: tsb_base(base), tsb_stamp(stamp)
+	{
+		const ULONG trans_per_tip = dbb->dbb_page_manager.transPerTIP;
+
+		string name;
+		name.printf(TPC_FILE, dbb->getUniqueFileId().c_str(), (ULONG) (base / trans_per_tip));
+
+		tsb_memory.reset(FB_NEW_POOL(*dbb->dbb_permanent)
+			SharedMemory<StatusBlockHeader>(name.c_str(), sizeof(StatusBlockHeader) + trans_per_tip / 4, this));
+
+		fb_assert(tsb_memory->getHeader()->mhb_header_version == MemoryHeader::HEADER_VERSION);
+		fb_assert(tsb_memory->getHeader()->mhb_version == STATUS_BLOCK_VERSION);
+	}
+
+	bool attach()
+	{
+		StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		tsb_memory->mutexLock();
+
+		const bool retired = header->tsb_retired && header->tsb_stamp == tsb_stamp;
+		if (!retired)
+		{
+			// The block is left by the processes of another generation,
+			// nobody uses it anymore whatever tsb_users says
+
+			if (header->tsb_stamp != tsb_stamp)
+			{
+				header->tsb_stamp = tsb_stamp;
+				header->tsb_users = 0;
+				header->tsb_retired = 0;
+			}
+
+			// Nobody else uses the block, its contents may be left by a crashed process
+
+			if (header->tsb_users++ == 0)
+				header->tsb_loaded = 0;
+		}
+
+		tsb_memory->mutexUnlock();
+
+		return !retired;
+	}
+
+	void detach(bool remove)
+	{
+		StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		tsb_memory->mutexLock();
+
+		// A new generation may have taken the block over already
+
+		if (header->tsb_stamp == tsb_stamp && (--header->tsb_users == 0 || remove))
+		{
+			header->tsb_retired = 1;
+			tsb_memory->removeMapFile();
+		}
+
+		tsb_memory->mutexUnlock();
+	}
+
+	int getState(TraNumber number) const
+	{
+		const StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		if (!header->tsb_loaded)
+			return -1;
+
+		return TRA_state(header->tsb_transactions, tsb_base, number);
+	}
+
+	void setState(ULONG byte, USHORT shift, SSHORT state)
+	{
+		StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		tsb_memory->mutexLock();
+
+		UCHAR* address = header->tsb_transactions + byte;
+		*address &= ~(TRA_MASK << shift);
+		*address |= state << shift;
+
+		tsb_memory->mutexUnlock();
+	}
+
+	void load(const UCHAR* transactions, ULONG length)
+	{
+		StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		tsb_memory->mutexLock();
+
+		memcpy(header->tsb_transactions, transactions, length);
+		header->tsb_loaded = 1;
+
+		tsb_memory->mutexUnlock();
+	}
+
+	bool copy(UCHAR* buffer, ULONG offset, ULONG length)
+	{
+		const StatusBlockHeader* const header = tsb_memory->getHeader();
+
+		tsb_memory->mutexLock();
+
+		const bool loaded = header->tsb_loaded;
+		if (loaded)
+			memcpy(buffer, header->tsb_transactions + offset, length);
+
+		tsb_memory->mutexUnlock();
+
+		return loaded;
+	}
+
+	bool initialize(SharedMemoryBase* sm, bool init)
+	{
+		if (init)
+		{
+			StatusBlockHeader* const header = reinterpret_cast<StatusBlockHeader*>(sm->sh_mem_header);
+
+			header->init(SharedMemoryBase::SRAM_TRANSACTION_STATES, STATUS_BLOCK_VERSION);
+			header->tsb_stamp = tsb_stamp;
+			header->tsb_users = 0;
+			header->tsb_loaded = 0;
+			header->tsb_retired = 0;
+		}
+
+		return true;
+	}
+
+	void mutexBug(int osErrorCode, const char* text)
+	{
+		string msg;
+		msg.printf("TIP CACHE: mutex %s error, status = %d", text, osErrorCode);
+		fb_utils::logAndDie(msg.c_str());
+	}
+
+	static TraNumber generate(const StatusBlock* item)
+	{
+		return item->tsb_base;
+	}
+
+	const TraNumber tsb_base;
+	const SINT64 tsb_stamp;
+	AutoPtr<SharedMemory<StatusBlockHeader> > tsb_memory;
+};
+
+
 TipCache::TipCache(Database* dbb)
 	: m_dbb(dbb),
-	  m_cache(*m_dbb->dbb_permanent)
+	  m_cache(*m_dbb->dbb_permanent),
+	  m_retired(*m_dbb->dbb_permanent),
+	  m_retiredOld(*m_dbb->dbb_permanent),
+	  m_blocks(*m_dbb->dbb_permanent),
+	  m_blockLock(NULL),
+	  m_blockStamp(0),
+	  m_blocksFailed(false)
 {
 }
 
@@ -51,6 +242,41 @@ TipCache::~TipCache()
 }
 
 
+void TipCache::shutdown(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	T P C _ s h u t d o w n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Unmap the shared status blocks and leave
+ *	the generation of processes using them.
+ *
+ **************************************/
+
+	SyncLockGuard sync(&m_sync, SYNC_EXCLUSIVE, "TipCache::shutdown");
+	SyncLockGuard blockSync(&m_blockSync, SYNC_EXCLUSIVE, "TipCache::shutdown");
+
+	while (m_blocks.hasData())
+	{
+		StatusBlock* const block = m_blocks.pop();
+		block->detach(false);
+		delete block;
+	}
+
+	if (m_blockLock)
+	{
+		LCK_release(tdbb, m_blockLock);
+		delete m_blockLock;
+		m_blockLock = NULL;
+	}
+
+	m_blockStamp = 0;
+}
+
+
 int TipCache::cacheState(thread_db* tdbb, TraNumber number)
 {
 /**************************************
@@ -67,6 +293,12 @@ int TipCache::cacheState(thread_db* tdbb, TraNumber number)
 	if (number && TRA_precommited(tdbb, number, number))
 		return tra_precommitted;
 
+	// the shared copy, if any, is more recent than the local one
+
+	int state;
+	if (!useSharedBlocks() && fastState(tdbb, number, state))
+		return state;
+
 	SyncLockGuard sync(&m_sync, SYNC_SHARED, "TipCache::cacheState");
 
 	if (!m_cache.getCount())
@@ -88,6 +320,11 @@ int TipCache::cacheState(thread_db* tdbb, TraNumber number)
 	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
 	const TraNumber base = number - number % trans_per_tip;
 
+	// the shared copy, if any, knows about the changes made by other processes
+
+	if (sharedState(number, state))
+		return state;
+
 	FB_SIZE_T pos;
 	if (m_cache.find(base, pos))
 	{
@@ -210,6 +447,60 @@ TraNumber TipCache::findStates(thread_db* tdbb, TraNumber minNumber, TraNumber m
 }
 
 
+bool TipCache::getInventory(UCHAR* bit_vector, TraNumber base, TraNumber top)
+{
+/**************************************
+ *
+ *	T P C _ g e t _ i n v e n t o r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get an inventory of the state of all transactions
+ *	between the base and top transactions passed from the
+ *	shared status blocks, caching them locally as well.
+ *	Return false if some of the blocks are not loaded yet,
+ *	the TIP pages must be read then.
+ *
+ **************************************/
+
+	if (!useSharedBlocks())
+		return false;
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+	const ULONG last = top / trans_per_tip;
+
+	SyncLockGuard sync(&m_sync, SYNC_EXCLUSIVE, "TipCache::getInventory");
+
+	HalfStaticArray<UCHAR, 4096> buffer;
+	UCHAR* const transactions = buffer.getBuffer(TRANS_OFFSET(trans_per_tip));
+	UCHAR* p = bit_vector;
+
+	for (ULONG sequence = base / trans_per_tip; sequence <= last; sequence++)
+	{
+		const TraNumber first_trans = (TraNumber) sequence * trans_per_tip;
+
+		StatusBlock* const block = getStatusBlock(first_trans);
+
+		if (!block || !block->copy(transactions, 0, TRANS_OFFSET(trans_per_tip)))
+			return false;
+
+		cachePage(first_trans, transactions);
+
+		if (p)
+		{
+			const TraNumber from = MAX(base, first_trans);
+			const ULONG skip = from - first_trans;
+			const ULONG l = TRANS_OFFSET(MIN((top + TRA_MASK + 1 - from), trans_per_tip - skip));
+			memcpy(p, transactions + TRANS_OFFSET(skip), l);
+			p += l;
+		}
+	}
+
+	return true;
+}
+
+
 void TipCache::initializeTpc(thread_db* tdbb, TraNumber number)
 {
 /**************************************
@@ -224,6 +515,9 @@ void TipCache::initializeTpc(thread_db* tdbb, TraNumber number)
  *
  **************************************/
 
+	if (!m_blockLock && useSharedBlocks())
+		initSharedBlocks(tdbb);
+
 	SyncLockGuard sync(&m_sync, SYNC_EXCLUSIVE, "TipCache::initializeTpc");
 
 	if (m_cache.isEmpty())
@@ -277,6 +571,12 @@ void TipCache::setState(TraNumber number, SSHORT state)
 
 	SyncLockGuard sync(&m_sync, SYNC_EXCLUSIVE, "TipCache::setState");
 
+	// let other processes know about the change too
+
+	StatusBlock* const block = getStatusBlock(base);
+	if (block)
+		block->setState(byte, shift, state);
+
 	FB_SIZE_T pos;
 	if (m_cache.find(base, pos))
 	{
@@ -318,75 +618,79 @@ int TipCache::snapshotState(thread_db* tdbb, TraNumber number)
 	if (number && TRA_precommited(tdbb, number, number))
 		return tra_precommitted;
 
-	SyncLockGuard sync(&m_sync, SYNC_SHARED, "TipCache::snapshotState");
+	int state;
 
-	if (m_cache.isEmpty())
+	if (useSharedBlocks() || !fastState(tdbb, number, state))
 	{
-		sync.unlock();
-		cacheTransactions(tdbb, 0);
-		sync.lock(SYNC_SHARED, "TipCache::snapshotState");
-	}
-
-	// if the transaction is older than the oldest
-	// transaction in our tip cache, it must be committed
-	// hvlad: system transaction always committed too
+		SyncLockGuard sync(&m_sync, SYNC_SHARED, "TipCache::snapshotState");
 
-	TxPage* tip_cache = m_cache.front();
-	if (number < tip_cache->tpc_base || number == 0)
-		return tra_committed;
+		if (m_cache.isEmpty())
+		{
+			sync.unlock();
+			cacheTransactions(tdbb, 0);
+			sync.lock(SYNC_SHARED, "TipCache::snapshotState");
+		}
 
-	// locate the specific TIP cache block for the transaction
+		// if the transaction is older than the oldest
+		// transaction in our tip cache, it must be committed
+		// hvlad: system transaction always committed too
 
-	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
-	const TraNumber base = number - number % trans_per_tip;
+		TxPage* tip_cache = m_cache.front();
+		if (number < tip_cache->tpc_base || number == 0)
+			return tra_committed;
 
-	FB_SIZE_T pos;
-	if (m_cache.find(base, pos))
-	{
-		tip_cache = m_cache[pos];
+		// locate the specific TIP cache block for the transaction
 
-		fb_assert(number >= tip_cache->tpc_base);
-		fb_assert(tip_cache->tpc_base < MAX_TRA_NUMBER - trans_per_tip);
-		fb_assert(number < (tip_cache->tpc_base + trans_per_tip));
+		const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+		const TraNumber base = number - number % trans_per_tip;
 
-		const int state = TRA_state(tip_cache->tpc_transactions, tip_cache->tpc_base, number);
+		FB_SIZE_T pos;
+		bool found = sharedState(number, state);
 
-		sync.unlock();
+		if (!found && m_cache.find(base, pos))
+		{
+			tip_cache = m_cache[pos];
 
-		// committed or dead transactions always stay that
-		// way, so no need to check their current state
+			fb_assert(number >= tip_cache->tpc_base);
+			fb_assert(tip_cache->tpc_base < MAX_TRA_NUMBER - trans_per_tip);
+			fb_assert(number < (tip_cache->tpc_base + trans_per_tip));
 
-		if (state == tra_committed || state == tra_dead)
-			return state;
+			state = TRA_state(tip_cache->tpc_transactions, tip_cache->tpc_base, number);
+			found = true;
+		}
 
-		// see if we can get a lock on the transaction; if we can't
-		// then we know it is still active
-		Lock temp_lock(tdbb, sizeof(TraNumber), LCK_tra);
-		temp_lock.setKey(number);
+		if (!found)
+		{
+			// if the transaction has been started since we last looked, extend the cache upward
 
-		// If we can't get a lock on the transaction, it must be active.
+			sync.unlock();
 
-		if (!LCK_lock(tdbb, &temp_lock, LCK_read, LCK_NO_WAIT))
-		{
-			fb_utils::init_status(tdbb->tdbb_status_vector);
-			return tra_active;
+			return extendCache(tdbb, number);
 		}
+	}
 
-		fb_utils::init_status(tdbb->tdbb_status_vector);
-		LCK_release(tdbb, &temp_lock);
+	// committed or dead transactions always stay that
+	// way, so no need to check their current state
 
-		// as a last resort we must look at the TIP page to see
-		// whether the transaction is committed or dead; to minimize
-		// having to do this again we will check the state of all
-		// other transactions on that page
+	if (state == tra_committed || state == tra_dead)
+		return state;
 
-		return TRA_fetch_state(tdbb, number);
-	}
-	// if the transaction has been started since we last looked, extend the cache upward
+	// see if we could get a lock on the transaction; if we can't
+	// then we know it is still active
+	Lock temp_lock(tdbb, sizeof(TraNumber), LCK_tra);
+	temp_lock.setKey(number);
 
-	sync.unlock();
+	// If we can't get a lock on the transaction, it must be active.
 
-	return extendCache(tdbb, number);
+	if (!LCK_test(tdbb, &temp_lock, LCK_read))
+		return tra_active;
+
+	// as a last resort we must look at the TIP page to see
+	// whether the transaction is committed or dead; to minimize
+	// having to do this again we will check the state of all
+	// other transactions on that page
+
+	return TRA_fetch_state(tdbb, number);
 }
 
 
@@ -415,38 +719,31 @@ void TipCache::updateCache(const Ods::tx_inv_page* tip_page, ULONG sequence)
 
 	SyncLockGuard sync(&m_sync, SYNC_EXCLUSIVE, "TipCache::updateCache");
 
-	TxPage* tip_cache = NULL;
-
 	while (m_cache.hasData())
 	{
-		tip_cache = m_cache.front();
+		TxPage* const tip_cache = m_cache.front();
 
 		fb_assert(tip_cache->tpc_base < MAX_TRA_NUMBER - trans_per_tip);
 		if (m_dbb->dbb_oldest_transaction >= (tip_cache->tpc_base + trans_per_tip))
 		{
 			m_cache.remove((FB_SIZE_T) 0);
-			delete tip_cache;
+			retirePage(tip_cache);
 		}
 		else
 			break;
 	}
 
-	// find the appropriate page in the TIP cache and assign all transaction
-	// bits -- it's not worth figuring out which ones are actually used
+	reclaimPages();
+	releaseStatusBlocks(m_dbb->dbb_oldest_transaction);
 
-	FB_SIZE_T pos;
-	if (m_cache.find(first_trans, pos))
-		tip_cache = m_cache[pos];
-	else
-	{
-		tip_cache = allocTxPage(first_trans);
-		m_cache.insert(pos, tip_cache);
-	}
+	cachePage(first_trans, tip_page->tip_transactions);
 
-	fb_assert(first_trans == tip_cache->tpc_base);
+	// the page is latched, so its image is the most recent one
+	// and may be published to other processes as is
 
-	const USHORT len = TRANS_OFFSET(trans_per_tip);
-	memcpy(tip_cache->tpc_transactions, tip_page->tip_transactions, len);
+	StatusBlock* const block = getStatusBlock(first_trans);
+	if (block)
+		block->load(tip_page->tip_transactions, TRANS_OFFSET(trans_per_tip));
 }
 
 
@@ -476,6 +773,46 @@ TipCache::TxPage* TipCache::allocTxPage(TraNumber base)
 }
 
 
+void TipCache::cachePage(TraNumber base, const UCHAR* transactions)
+{
+/**************************************
+ *
+ *	c a c h e _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find the appropriate page in the TIP cache and assign
+ *	all transaction bits -- it's not worth figuring out
+ *	which ones are actually used.
+ *
+ **************************************/
+	fb_assert(m_sync.ourExclusiveLock());
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+
+	const USHORT len = TRANS_OFFSET(trans_per_tip);
+
+	FB_SIZE_T pos;
+	if (m_cache.find(base, pos))
+	{
+		TxPage* const tip_cache = m_cache[pos];
+		fb_assert(base == tip_cache->tpc_base);
+
+		memcpy(tip_cache->tpc_transactions, transactions, len);
+		return;
+	}
+
+	// a new page is made visible to the lock-free readers only when filled
+
+	TxPage* const tip_cache = allocTxPage(base);
+	memcpy(tip_cache->tpc_transactions, transactions, len);
+
+	m_cache.insert(pos, tip_cache);
+	publishPage(tip_cache);
+}
+
+
 TraNumber TipCache::cacheTransactions(thread_db* tdbb, TraNumber oldest)
 {
 /**************************************
@@ -532,12 +869,14 @@ TraNumber TipCache::cacheTransactions(thread_db* tdbb, TraNumber oldest)
 		if ((tip_cache->tpc_base + trans_per_tip) < hdr_oldest)
 		{
 			m_cache.remove((FB_SIZE_T) 0);
-			delete tip_cache;
+			retirePage(tip_cache);
 		}
 		else
 			break;
 	}
 
+	reclaimPages();
+
 	return hdr_oldest;
 }
 
@@ -546,8 +885,26 @@ void TipCache::clearCache()
 {
 	fb_assert(m_sync.ourExclusiveLock());
 
+	// there are no readers anymore
+
 	while (m_cache.hasData())
 		delete m_cache.pop();
+
+	while (m_retired.hasData())
+		delete m_retired.pop();
+
+	while (m_retiredOld.hasData())
+		delete m_retiredOld.pop();
+
+	for (ULONG slot = 0; slot < DIRECTORY_SIZE; slot++)
+		m_directory[slot] = NULL;
+
+	while (m_blocks.hasData())
+	{
+		StatusBlock* const block = m_blocks.pop();
+		block->detach(false);
+		delete block;
+	}
 }
 
 
@@ -596,6 +953,10 @@ int TipCache::extendCache(thread_db* tdbb, TraNumber number)
 
 	// find the right block for this transaction and return the state
 
+	int state;
+	if (sharedState(number, state))
+		return state;
+
 	const TraNumber base = number - number % trans_per_tip;
 
 	FB_SIZE_T pos;
@@ -617,4 +978,363 @@ int TipCache::extendCache(thread_db* tdbb, TraNumber number)
 	return tra_active;
 }
 
+
+bool TipCache::fastState(thread_db* tdbb, TraNumber number, int& state)
+{
+/**************************************
+ *
+ *	f a s t _ s t a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get the state of a transaction from the page
+ *	published in the directory, without locking.
+ *	Return false if the page is not published,
+ *	the caller should look at the cache then.
+ *
+ **************************************/
+
+	if (number == 0)
+	{
+		state = tra_committed;
+		return true;
+	}
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+	const TraNumber sequence = number / trans_per_tip;
+	const TraNumber base = sequence * trans_per_tip;
+
+	// thread_db lives on the stack of its thread,
+	// so its address tells the threads apart
+
+	FB_UINT64 key = (FB_UINT64) (IPTR) tdbb;
+	key ^= key >> 12;
+	key ^= key >> 24;
+	ReaderSlot& reader = m_readers[key % READER_SLOTS];
+
+	// Register as a reader of the current epoch. If the epoch is switched
+	// meanwhile, the counter may be already checked by reclaimPages().
+
+	AtomicCounter* counter;
+
+	while (true)
+	{
+		const AtomicCounter::counter_type epoch = m_epoch.value();
+		counter = &reader.rs_count[epoch & 1];
+		++(*counter);
+
+		if (m_epoch.value() == epoch)
+			break;
+
+		--(*counter);
+	}
+
+	const TxPage* const tip_cache = m_directory[sequence % DIRECTORY_SIZE].value();
+	const bool found = (tip_cache && tip_cache->tpc_base == base);
+
+	if (found)
+		state = TRA_state(tip_cache->tpc_transactions, base, number);
+
+	--(*counter);
+
+	return found;
+}
+
+
+void TipCache::publishPage(TxPage* tip_cache)
+{
+/**************************************
+ *
+ *	p u b l i s h _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make the cached page visible to the lock-free
+ *	readers. If the directory slot is taken by another
+ *	page, the most recent one wins.
+ *
+ **************************************/
+	fb_assert(m_sync.ourExclusiveLock());
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+	AtomicPointer<TxPage>& slot = m_directory[(tip_cache->tpc_base / trans_per_tip) % DIRECTORY_SIZE];
+
+	TxPage* const current = slot.value();
+
+	if (!current || current->tpc_base < tip_cache->tpc_base)
+	{
+		// compare-and-swap is a full barrier, the page contents are visible
+		// to the readers before the page itself
+
+		slot.compareExchange(current, tip_cache);
+	}
+}
+
+
+void TipCache::reclaimPages()
+{
+/**************************************
+ *
+ *	r e c l a i m _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Free the pages retired before the last epoch switch
+ *	when the readers registered in the previous epoch are
+ *	gone, and switch the epoch for the recently retired ones.
+ *
+ **************************************/
+	fb_assert(m_sync.ourExclusiveLock());
+
+	if (m_retiredOld.hasData())
+	{
+		const int previous = (m_epoch.value() + 1) & 1;
+
+		for (ULONG i = 0; i < READER_SLOTS; i++)
+		{
+			if (m_readers[i].rs_count[previous].value())
+				return;
+		}
+
+		while (m_retiredOld.hasData())
+			delete m_retiredOld.pop();
+	}
+
+	if (m_retired.hasData())
+	{
+		m_retiredOld.assign(m_retired);
+		m_retired.clear();
+		++m_epoch;
+	}
+}
+
+
+void TipCache::retirePage(TxPage* tip_cache)
+{
+/**************************************
+ *
+ *	r e t i r e _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Hide the page removed from the cache from the
+ *	lock-free readers. It's freed by reclaimPages()
+ *	when nobody could read it anymore.
+ *
+ **************************************/
+	fb_assert(m_sync.ourExclusiveLock());
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+	AtomicPointer<TxPage>& slot = m_directory[(tip_cache->tpc_base / trans_per_tip) % DIRECTORY_SIZE];
+
+	slot.compareExchange(tip_cache, NULL);
+	m_retired.add(tip_cache);
+}
+
+
+TipCache::StatusBlock* TipCache::getStatusBlock(TraNumber base)
+{
+/**************************************
+ *
+ *	g e t _ s t a t u s _ b l o c k
+ *
+ **************************************
+ *
+ * Functional description
+ *	Find or map the shared status block for
+ *	the TIP page starting with the given transaction.
+ *	Return NULL if the shared blocks are not used.
+ *	m_sync should be locked here.
+ *
+ **************************************/
+
+	if (!useSharedBlocks() || !m_blockStamp)
+		return NULL;
+
+	FB_SIZE_T pos;
+
+	{	// scope
+		SyncLockGuard sync(&m_blockSync, SYNC_SHARED, "TipCache::getStatusBlock");
+
+		if (m_blocks.find(base, pos))
+			return m_blocks[pos];
+	}
+
+	SyncLockGuard sync(&m_blockSync, SYNC_EXCLUSIVE, "TipCache::getStatusBlock");
+
+	if (m_blocks.find(base, pos))
+		return m_blocks[pos];
+
+	// The file of a block which was released by another process could be
+	// still opened here, so map it once again if it happens
+
+	for (int attempt = 0; attempt < 2; attempt++)
+	{
+		StatusBlock* block = NULL;
+
+		try
+		{
+			block = FB_NEW_POOL(*m_dbb->dbb_permanent) StatusBlock(m_dbb, base, m_blockStamp);
+		}
+		catch (const Exception& ex)
+		{
+			iscLogException("TipCache: Cannot initialize the shared memory region", ex);
+			m_blocksFailed = true;
+			return NULL;
+		}
+
+		if (block->attach())
+		{
+			m_blocks.insert(pos, block);
+			return block;
+		}
+
+		delete block;
+	}
+
+	return NULL;
+}
+
+
+void TipCache::initSharedBlocks(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	i n i t _ s h a r e d _ b l o c k s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take the lock binding the shared status blocks
+ *	to the processes which have the database open
+ *	and get the stamp of their generation. If this
+ *	is the first such process, start a new one.
+ *
+ **************************************/
+
+	Lock* const lock = FB_NEW_RPT(*m_dbb->dbb_permanent, 0) Lock(tdbb, 0, LCK_tpc_init);
+
+	SINT64 stamp = 0;
+
+	if (LCK_lock(tdbb, lock, LCK_EX, LCK_NO_WAIT))
+	{
+		while (!stamp)
+			GenerateRandomBytes(&stamp, sizeof(stamp));
+
+		LCK_write_data(tdbb, lock, stamp);
+		LCK_convert(tdbb, lock, LCK_SR, LCK_WAIT);
+	}
+	else
+	{
+		fb_utils::init_status(tdbb->tdbb_status_vector);
+
+		if (LCK_lock(tdbb, lock, LCK_SR, LCK_WAIT))
+			stamp = LCK_read_data(tdbb, lock);
+		else
+			fb_utils::init_status(tdbb->tdbb_status_vector);
+	}
+
+	if (!stamp)
+	{
+		if (lock->lck_logical != LCK_none)
+			LCK_release(tdbb, lock);
+
+		delete lock;
+		m_blocksFailed = true;
+		return;
+	}
+
+	SyncLockGuard sync(&m_blockSync, SYNC_EXCLUSIVE, "TipCache::initSharedBlocks");
+
+	if (m_blockLock)
+	{
+		LCK_release(tdbb, lock);
+		delete lock;
+		return;
+	}
+
+	m_blockLock = lock;
+	m_blockStamp = stamp;
+}
+
+
+void TipCache::releaseStatusBlocks(TraNumber oldest)
+{
+/**************************************
+ *
+ *	r e l e a s e _ s t a t u s _ b l o c k s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Unmap the shared status blocks below the oldest
+ *	interesting transaction. States of such transactions
+ *	never change, so the files are removed even if other
+ *	processes still use them.
+ *
+ **************************************/
+	fb_assert(m_sync.ourExclusiveLock());
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+
+	SyncLockGuard sync(&m_blockSync, SYNC_EXCLUSIVE, "TipCache::releaseStatusBlocks");
+
+	while (m_blocks.hasData())
+	{
+		StatusBlock* const block = m_blocks.front();
+
+		if (oldest < block->tsb_base + trans_per_tip)
+			break;
+
+		m_blocks.remove((FB_SIZE_T) 0);
+		block->detach(true);
+		delete block;
+	}
+}
+
+
+bool TipCache::sharedState(TraNumber number, int& state)
+{
+/**************************************
+ *
+ *	s h a r e d _ s t a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get the state of a transaction from the shared
+ *	status block. Return false if there is no loaded
+ *	block for the transaction.
+ *	m_sync should be locked here.
+ *
+ **************************************/
+
+	const ULONG trans_per_tip = m_dbb->dbb_page_manager.transPerTIP;
+	const StatusBlock* const block = getStatusBlock(number - number % trans_per_tip);
+
+	if (!block)
+		return false;
+
+	const int shared_state = block->getState(number);
+
+	if (shared_state < 0)
+		return false;
+
+	state = shared_state;
+	return true;
+}
+
+
+bool TipCache::useSharedBlocks() const
+{
+	// Database object shared by all attachments has the single TIP cache anyway,
+	// and states in a read-only database are never stored in the TIP pages
+
+	return !(m_dbb->dbb_flags & DBB_shared) && !m_dbb->readOnly() && !m_blocksFailed;
+}
+
 } // namespace Jrd
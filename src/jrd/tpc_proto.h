@@ -26,6 +26,7 @@
 
 #include "../common/classes/array.h"
 #include "../common/classes/SyncObject.h"
+#include "../common/classes/fb_atomic.h"
 
 namespace Ods {
 struct tx_inv_page;
@@ -34,6 +35,7 @@ struct tx_inv_page;
 namespace Jrd {
 
 class Database;
+class Lock;
 class thread_db;
 
 class TipCache
@@ -44,8 +46,10 @@ public:
 
 	int cacheState(thread_db*, TraNumber number);
 	TraNumber findStates(thread_db* tdbb, TraNumber minNumber, TraNumber maxNumber, ULONG mask, int& state);
+	bool getInventory(UCHAR* bit_vector, TraNumber base, TraNumber top);
 	void initializeTpc(thread_db*, TraNumber number);
 	void setState(TraNumber number, SSHORT state);
+	void shutdown(thread_db* tdbb);
 	int snapshotState(thread_db*, TraNumber number);
 	void updateCache(const Ods::tx_inv_page* tip_page, ULONG sequence);
 
@@ -56,20 +60,63 @@ private:
 		TraNumber tpc_base;			// id of first transaction in this block
 		UCHAR tpc_transactions[1];	// two bits per transaction
 
-		static const TraNumber generate(const TxPage* item)
+		static TraNumber generate(const TxPage* item)
 		{
 			return item->tpc_base;
 		}
 	};
 
+	// Copy of the TIP page states kept in the shared memory, see tpc.cpp
+	class StatusBlock;
+
+	// Cached pages are also published in a fixed directory, addressed by
+	// the TIP page sequence, for lookups without m_sync. Pages removed from
+	// the cache are freed after a grace period: readers register themselves
+	// in a counter of the current epoch, and pages retired before an epoch
+	// switch are freed when the counters of the previous epoch drain.
+
+	static const ULONG DIRECTORY_SIZE = 4096;
+	static const ULONG READER_SLOTS = 64;
+
+	struct ReaderSlot
+	{
+		Firebird::AtomicCounter rs_count[2];
+		char rs_padding[64];		// keep slots on separate cache lines
+	};
+
 	TxPage* allocTxPage(TraNumber base);
+	void cachePage(TraNumber base, const UCHAR* transactions);
 	TraNumber cacheTransactions(thread_db* tdbb, TraNumber oldest);
 	int extendCache(thread_db* tdbb, TraNumber number);
 	void clearCache();
 
+	StatusBlock* getStatusBlock(TraNumber base);
+	void initSharedBlocks(thread_db* tdbb);
+	void releaseStatusBlocks(TraNumber oldest);
+	bool sharedState(TraNumber number, int& state);
+
+	bool useSharedBlocks() const;
+
+	bool fastState(thread_db* tdbb, TraNumber number, int& state);
+	void publishPage(TxPage* tip_cache);
+	void reclaimPages();
+	void retirePage(TxPage* tip_cache);
+
 	Database* m_dbb;
 	Firebird::SyncObject m_sync;
 	Firebird::SortedArray<TxPage*, Firebird::EmptyStorage<TxPage*>, TraNumber, TxPage> m_cache;
+
+	Firebird::AtomicPointer<TxPage> m_directory[DIRECTORY_SIZE];
+	ReaderSlot m_readers[READER_SLOTS];
+	Firebird::AtomicCounter m_epoch;
+	Firebird::HalfStaticArray<TxPage*, 16> m_retired;		// retired in the current epoch
+	Firebird::HalfStaticArray<TxPage*, 16> m_retiredOld;	// retired before the epoch switch
+
+	Firebird::SyncObject m_blockSync;
+	Firebird::SortedArray<StatusBlock*, Firebird::EmptyStorage<StatusBlock*>, TraNumber, StatusBlock> m_blocks;
+	Lock* m_blockLock;			// shared lock of the processes using the blocks
+	SINT64 m_blockStamp;		// generation stamp taken from the lock data
+	bool m_blocksFailed;
 };
 
 
@@ -84,6 +131,11 @@ inline TraNumber TPC_find_states(thread_db* tdbb, TraNumber minNumber, TraNumber
 	return tdbb->getDatabase()->dbb_tip_cache->findStates(tdbb, minNumber, maxNumber, mask, state);
 }
 
+inline bool TPC_get_inventory(thread_db* tdbb, UCHAR* bit_vector, TraNumber base, TraNumber top)
+{
+	return tdbb->getDatabase()->dbb_tip_cache->getInventory(bit_vector, base, top);
+}
+
 inline void TPC_initialize_tpc(thread_db* tdbb, TraNumber number)
 {
 	 tdbb->getDatabase()->dbb_tip_cache->initializeTpc(tdbb, number);
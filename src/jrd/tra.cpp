@@ -560,6 +560,11 @@ void TRA_get_inventory(thread_db* tdbb, UCHAR* bit_vector, TraNumber base, TraNu
 	Database* dbb = tdbb->getDatabase();
 	CHECK_DBB(dbb);
 
+	// Classic processes may find all the states in the shared TIP cache
+
+	if (dbb->dbb_tip_cache && TPC_get_inventory(tdbb, bit_vector, base, top))
+		return;
+
 	const ULONG trans_per_tip = dbb->dbb_page_manager.transPerTIP;
 	ULONG sequence = base / trans_per_tip;
 	const ULONG last = top / trans_per_tip;
@@ -941,14 +946,7 @@ bool TRA_pc_active(thread_db* tdbb, TraNumber number)
 
 	// If we can't get a lock on the transaction, it must be active
 
-	if (!LCK_lock(tdbb, &temp_lock, LCK_read, LCK_NO_WAIT))
-	{
-		fb_utils::init_status(tdbb->tdbb_status_vector);
-		return true;
-	}
-
-	LCK_release(tdbb, &temp_lock);
-	return false;
+	return !LCK_test(tdbb, &temp_lock, LCK_read);
 }
 
 
@@ -1474,13 +1472,15 @@ void TRA_set_state(thread_db* tdbb, jrd_tra* transaction, TraNumber number, int
 	*address &= ~(TRA_MASK << shift);
 	*address |= state << shift;
 
-	// set the new state in the TIP cache as well
+	CCH_RELEASE(tdbb, &window);
+
+	// set the new state in the TIP cache as well. Do it after the page is
+	// released (and written, if required) as other processes could see the
+	// new state in the shared TIP cache at once.
 
 	if (dbb->dbb_tip_cache)
 		TPC_set_state(tdbb, number, state);
 
-	CCH_RELEASE(tdbb, &window);
-
 #ifdef SUPERSERVER_V2
 	// Let the TIP be lazily updated for read-only queries.
 	// To amortize write of TIP page for update transactions,
@@ -1567,7 +1567,14 @@ int TRA_snapshot_state(thread_db* tdbb, const jrd_tra* trans, TraNumber number)
 	if (number > trans->tra_top)
 		return tra_active;
 
-	return TRA_state(trans->tra_transactions.begin(), trans->tra_oldest, number);
+	// Transactions older than the oldest active one at our start are not
+	// copied into the snapshot, their states are final and the TIP cache
+	// knows them as well.
+
+	if (number < trans->tra_snapshot_base)
+		return TPC_snapshot_state(tdbb, number);
+
+	return TRA_state(trans->tra_transactions.begin(), trans->tra_snapshot_base, number);
 }
 
 
@@ -1675,6 +1682,24 @@ jrd_tra* TRA_start(thread_db* tdbb, int tpb_length, const UCHAR* tpb, Jrd::jrd_t
 }
 
 
+jrd_tra* TRA_start_sweep(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	T R A _ s t a r t _ s w e e p
+ *
+ **************************************
+ *
+ * Functional description
+ *	Start a transaction to sweep the database.
+ *	The helpers of a parallel sweep use it too.
+ *
+ **************************************/
+
+	return TRA_start(tdbb, sizeof(sweep_tpb), sweep_tpb);
+}
+
+
 int TRA_state(const UCHAR* bit_vector, TraNumber oldest, TraNumber number)
 {
 /**************************************
@@ -1747,7 +1772,7 @@ void TRA_sweep(thread_db* tdbb)
 		// during the course of the database sweep. Since it is used
 		// below to advance the OIT we must save it before it changes.
 
-		transaction = TRA_start(tdbb, sizeof(sweep_tpb), sweep_tpb);
+		transaction = TRA_start_sweep(tdbb);
 
 		TraNumber transaction_oldest_active = transaction->tra_oldest_active;
 		tdbb->setTransaction(transaction);
@@ -1904,10 +1929,10 @@ int TRA_wait(thread_db* tdbb, jrd_tra* trans, TraNumber number, jrd_tra::wait_t
 	// died, tweak the transaction state snapshot to reflect the new state.
 	// This is guaranteed safe.
 
-	const ULONG byte = TRANS_OFFSET(number - (trans->tra_oldest & ~TRA_MASK));
+	const ULONG byte = TRANS_OFFSET(number - trans->tra_snapshot_base);
 	const USHORT shift = TRANS_SHIFT(number);
 
-	if (trans->tra_flags & TRA_read_committed)
+	if ((trans->tra_flags & TRA_read_committed) || number < trans->tra_snapshot_base)
 		TPC_set_state(tdbb, number, state);
 	else
 	{
@@ -2427,6 +2452,12 @@ static void retain_context(thread_db* tdbb, jrd_tra* transaction, bool commit, i
 	if (commit)
 		TBM_SET(tdbb->getDefaultPool(), &transaction->tra_commit_sub_trans, transaction->tra_number);
 
+	// The snapshot is going to see versions written under numbers newer than
+	// its own one, intermediate versions can't be judged by the number anymore
+
+	if (transaction->tra_flags & TRA_snapshot_listed)
+		dbb->dbb_active_snapshots.retain(transaction->tra_top);
+
 	// Create a new transaction lock, inheriting oldest active from transaction being committed.
 
 	WIN window(DB_PAGE_SPACE, -1);
@@ -3148,12 +3179,15 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 	// or cleaned up, they can be all considered as committed.  To
 	// make everything simpler, round down the oldest to a multiple
 	// of four, which puts the transaction on a byte boundary.
+	// Transactions older than the oldest active are not active anymore
+	// and their states are final, so they are left to the TIP cache.
+	// This way a stuck OIT doesn't make every snapshot bigger.
 
-	TraNumber base = oldest & ~TRA_MASK;
+	const TraNumber base = (dbb->dbb_tip_cache ? active : oldest) & ~TRA_MASK;
 	const TraNumber top = (dbb->dbb_flags & DBB_read_only) ?
 		dbb->dbb_next_transaction : number;
 
-	if (!(trans->tra_flags & TRA_read_committed) && (top >= oldest))
+	if (!(trans->tra_flags & TRA_read_committed) && (top >= base))
 	{
 		const FB_SIZE_T length = (top + 1 - base + TRA_MASK) / 4;
 		trans->tra_transactions.resize(length);
@@ -3162,8 +3196,21 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 	trans->tra_number = number;
 	trans->tra_top = top;
 	trans->tra_oldest = oldest;
+	trans->tra_snapshot_base = base;
 	trans->tra_oldest_active = active;
 
+	// Let garbage collection know about the new snapshot before anybody else
+	// could start and commit a transaction it isn't going to see. Until the
+	// inventory is taken nothing is known about the transactions it sees,
+	// so it's registered as needing every version written before it.
+
+	if ((dbb->dbb_flags & DBB_shared) && !dbb->readOnly() &&
+		!((trans->tra_flags & TRA_readonly) && (trans->tra_flags & TRA_read_committed)))
+	{
+		dbb->dbb_active_snapshots.add(top, 0);
+		trans->tra_flags |= TRA_snapshot_listed;
+	}
+
 	trans->tra_lock = lock;
 	lock->setKey(number);
 
@@ -3222,11 +3269,25 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 		Lock temp_lock(tdbb, sizeof(TraNumber), LCK_tra, trans);
 
 		trans->tra_oldest_active = number;
-		base = oldest & ~TRA_MASK;
 		oldest_active = number;
 		bool cleanup = !(number % TRA_ACTIVE_CLEANUP);
 		int oldest_state;
 
+		// A read-only read committed transaction is precommitted below and never
+		// holds back garbage collection. Don't bother the lock manager looking for
+		// the oldest active snapshot, the values cached by the other transactions
+		// are good enough to decide what this one may garbage collect.
+
+		const bool precommit = (trans->tra_flags & TRA_readonly) &&
+			(trans->tra_flags & TRA_read_committed);
+
+		if (precommit)
+		{
+			oldest_active = active;
+			trans->tra_oldest_active = MIN(MAX(oldest_snapshot, dbb->dbb_oldest_snapshot), number);
+			active = top;
+		}
+
 		for (; active < top; active++)
 		{
 			if (trans->tra_flags & TRA_read_committed)
@@ -3320,23 +3381,32 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 		if (lock->lck_data != (SLONG) lck_data)
 			LCK_write_data(tdbb, lock, lck_data);
 
+		if (trans->tra_flags & TRA_snapshot_listed)
+			dbb->dbb_active_snapshots.add(top, lck_data);
+
 		// Finally, scan transactions looking for the oldest interesting transaction -- the oldest
 		// non-commited transaction.  This will not be updated immediately, but saved until the
-		// next update access to the header page
+		// next update access to the header page. A precommitted transaction leaves
+		// this to the others as well.
 
 		oldest_state = tra_committed;
 
-		for (oldest = trans->tra_oldest; oldest < top; oldest++)
+		for (oldest = trans->tra_oldest; !precommit && oldest < top; oldest++)
 		{
-			if (trans->tra_flags & TRA_read_committed)
+			if ((trans->tra_flags & TRA_read_committed) || oldest < base)
 			{
+				// The part of the inventory not copied into the snapshot
+				// is looked up in the TIP cache
+
+				const TraNumber limit = (trans->tra_flags & TRA_read_committed) ? top : base;
 				const ULONG mask = ~((1 << tra_committed) | (1 << tra_precommitted));
-				oldest = TPC_find_states(tdbb, trans->tra_oldest, top, mask, oldest_state);
-				if (!oldest)
+				const TraNumber found = TPC_find_states(tdbb, oldest, limit, mask, oldest_state);
+				if (!found)
 				{
-					oldest = top;
-					break;
+					oldest = limit - 1;
+					continue;
 				}
+				oldest = found;
 				fb_assert(oldest_state != tra_committed && oldest_state != tra_precommitted);
 			}
 			else
@@ -3426,6 +3496,9 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 
 jrd_tra::~jrd_tra()
 {
+	if (tra_flags & TRA_snapshot_listed)
+		tra_attachment->att_database->dbb_active_snapshots.remove(tra_top);
+
 	while (tra_undo_records.hasData())
 		delete tra_undo_records.pop();
 
@@ -3819,6 +3892,38 @@ void TraceSweepEvent::endSweepRelation(jrd_rel* relation)
 }
 
 
+void TraceSweepEvent::endSweepRelation(jrd_rel* relation, RuntimeStatistics& stats, SINT64 elapsed)
+{
+	// Report relation swept in parallel, stats are collected by all sweeping attachments
+
+	if (!m_need_trace)
+		return;
+
+	// don't report empty relation
+	if (!stats.getValue(RuntimeStatistics::RECORD_SEQ_READS) &&
+		!stats.getValue(RuntimeStatistics::RECORD_BACKOUTS) &&
+		!stats.getValue(RuntimeStatistics::RECORD_PURGES) &&
+		!stats.getValue(RuntimeStatistics::RECORD_EXPUNGES))
+	{
+		return;
+	}
+
+	if (relation && relation->rel_name.isEmpty())
+		MET_lookup_relation_id(m_tdbb, relation->rel_id, false);
+
+	Attachment* att = m_tdbb->getAttachment();
+
+	RuntimeStatistics base_stats;
+	TraceRuntimeStats trace_stats(att, &base_stats, &stats, elapsed, 0);
+
+	m_sweep_info.setPerf(trace_stats.getPerf());
+
+	TraceConnectionImpl conn(att);
+	TraceManager* trace_mgr = att->att_trace_manager;
+	trace_mgr->event_sweep(&conn, &m_sweep_info, ITracePlugin::SWEEP_STATE_PROGRESS);
+}
+
+
 void TraceSweepEvent::report(ntrace_process_state_t state)
 {
 	Attachment* att = m_tdbb->getAttachment();
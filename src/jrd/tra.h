@@ -249,6 +249,7 @@ public:
 	TraNumber tra_number;				// transaction number
 	TraNumber tra_top;					// highest transaction in snapshot
 	TraNumber tra_oldest;				// oldest interesting transaction
+	TraNumber tra_snapshot_base;		// first transaction in tra_transactions
 	TraNumber tra_oldest_active;		// record versions older than this can be
 										// gargage-collected by this tx
 	TraNumber tra_att_oldest_active;	// oldest active transaction in the same attachment
@@ -409,6 +410,7 @@ const ULONG TRA_restart_requests	= 0x4000L;	// restart all requests in attachmen
 const ULONG TRA_no_auto_undo		= 0x8000L;	// don't start a savepoint in TRA_start
 const ULONG TRA_precommitted		= 0x10000L;	// transaction committed at startup
 const ULONG TRA_own_interface		= 0x20000L;	// tra_interface was created for internal needs
+const ULONG TRA_snapshot_listed		= 0x40000L;	// transaction is listed in dbb_active_snapshots
 
 // flags derived from TPB, see also transaction_options() at tra.cpp
 const ULONG TRA_OPTIONS_MASK = (TRA_degree3 | TRA_readonly | TRA_ignore_limbo | TRA_read_committed |
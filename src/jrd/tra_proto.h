@@ -58,6 +58,7 @@ void	TRA_set_state(Jrd::thread_db* tdbb, Jrd::jrd_tra* transaction, TraNumber nu
 int		TRA_snapshot_state(Jrd::thread_db* tdbb, const Jrd::jrd_tra*, TraNumber number);
 Jrd::jrd_tra*	TRA_start(Jrd::thread_db* tdbb, ULONG flags, SSHORT lock_timeout, Jrd::jrd_tra* outer = NULL);
 Jrd::jrd_tra*	TRA_start(Jrd::thread_db* tdbb, int, const UCHAR*, Jrd::jrd_tra* outer = NULL);
+Jrd::jrd_tra*	TRA_start_sweep(Jrd::thread_db* tdbb);
 int		TRA_state(const UCHAR*, TraNumber oldest, TraNumber number);
 void	TRA_sweep(Jrd::thread_db* tdbb);
 void	TRA_update_counters(Jrd::thread_db*, Jrd::Database*);
@@ -510,6 +510,7 @@ public:
 
 	void beginSweepRelation(jrd_rel* relation);
 	void endSweepRelation(jrd_rel* relation);
+	void endSweepRelation(jrd_rel* relation, RuntimeStatistics& stats, SINT64 elapsed);
 
 	void finish()
 	{
@@ -106,6 +106,9 @@ static void expunge(thread_db*, record_param*, const jrd_tra*, ULONG);
 static bool dfw_should_know(thread_db*, record_param* org_rpb, record_param* new_rpb,
 	USHORT irrelevant_field, bool void_update_is_relevant = false);
 static void garbage_collect(thread_db*, record_param*, ULONG, RecordStack&);
+static bool garbage_collect_pages(thread_db*, record_param&, jrd_tra*&, jrd_rel*, PageBitmap*, bool&);
+static void garbage_collector_main(thread_db*, void*);
+static void gc_worker_main(thread_db*, void*);
 
 
 #ifdef VIO_DEBUG
@@ -148,6 +151,19 @@ static void list_staying(thread_db*, record_param*, RecordStack&);
 static void list_staying_fast(thread_db*, record_param*, RecordStack&, record_param* = NULL);
 static void notify_garbage_collector(thread_db* tdbb, record_param* rpb,
 	TraNumber tranid = MAX_TRA_NUMBER);
+static void notify_index_changes(thread_db*, jrd_rel*);
+
+// Garbage collector helper threads take the marked data pages in batches of this size
+const ULONG GC_BATCH_PAGES	= 64;
+const int MAX_GC_WORKERS	= 16;
+
+// Parallel sweep hands out relations in ranges of this many pointer pages
+const ULONG SWEEP_RANGE_POINTERS	= 8;
+const int MAX_SWEEP_WORKERS			= 16;
+
+// A reader walking this many back versions asks the garbage collector to look
+// for intermediate versions which no snapshot needs anymore
+const ULONG INTERMEDIATE_GC_DEPTH	= 8;
 
 const int PREPARE_OK		= 0;
 const int PREPARE_CONFLICT	= 1;
@@ -162,12 +178,17 @@ static void protect_system_table_insert(thread_db* tdbb, const jrd_req* req, con
 static void protect_system_table_delupd(thread_db* tdbb, const jrd_rel* relation, const char* operation,
 	bool force_flag = false);
 static void purge(thread_db*, record_param*);
+static bool purge_intermediate(thread_db*, record_param*, jrd_tra*);
 static void replace_record(thread_db*, record_param*, PageStack*, const jrd_tra*);
 static void refresh_fk_fields(thread_db*, Record*, record_param*, record_param*);
 static SSHORT set_metadata_id(thread_db*, Record*, USHORT, drq_type_t, const char*);
 static void set_owner_name(thread_db*, Record*, USHORT);
 static bool set_security_class(thread_db*, Record*, USHORT);
 static void set_system_flag(thread_db*, Record*, USHORT);
+static bool sweep_parallel(thread_db*, jrd_tra*, TraceSweepEvent*, int);
+static bool sweep_range(thread_db*, jrd_tra*, record_param&, USHORT, ULONG, ULONG);
+static THREAD_ENTRY_DECLARE sweep_worker(THREAD_ENTRY_PARAM);
+static void sweep_worker_main(thread_db*, void*);
 static void verb_post(thread_db*, jrd_tra*, record_param*, Record*);
 
 static bool assert_gc_enabled(const jrd_tra* transaction, const jrd_rel* relation)
@@ -270,16 +291,13 @@ inline bool checkGCActive(thread_db* tdbb, record_param* rpb, int& state)
 	Lock temp_lock(tdbb, sizeof(SINT64), LCK_record_gc);
 	temp_lock.setKey(((SINT64) rpb->rpb_page << 16) | rpb->rpb_line);
 
-	ThreadStatusGuard temp_status(tdbb);
-
-	if (!LCK_lock(tdbb, &temp_lock, LCK_SR, LCK_NO_WAIT))
+	if (!LCK_test(tdbb, &temp_lock, LCK_SR))
 	{
 		rpb->rpb_transaction_nr = LCK_read_data(tdbb, &temp_lock);
 		state = tra_active;
 		return true;
 	}
 
-	LCK_release(tdbb, &temp_lock);
 	rpb->rpb_flags &= ~rpb_gc_active;
 	state = tra_dead;
 	return false;
@@ -319,6 +337,138 @@ static const UCHAR gc_tpb[] =
 };
 
 
+namespace
+{
+	// Parallel sweep. Relations are split into ranges of pointer pages which are
+	// handed out to the sweeping attachment and its helper threads.
+
+	class SweepTask
+	{
+	public:
+		struct Item
+		{
+			FB_SIZE_T relation;		// position in m_relations
+			ULONG ppFrom;			// first pointer page sequence
+			ULONG ppTo;				// pointer page sequence to stop at, zero means the end
+		};
+
+		struct RelationInfo
+		{
+			explicit RelationInfo(MemoryPool& p)
+				: relID(0), pending(0), clock(0), stats(p)
+			{}
+
+			USHORT relID;
+			ULONG pending;			// ranges not swept yet
+			SINT64 clock;			// when the first range was taken
+			RuntimeStatistics stats;
+		};
+
+		SweepTask(MemoryPool& p, Database* dbb)
+			: m_dbb(dbb), m_items(p), m_next(0), m_relations(p), m_finished(p), m_failed(false)
+		{}
+
+		Database* getDatabase() const
+		{
+			return m_dbb;
+		}
+
+		void addRelation(USHORT relID, ULONG pointerPages)
+		{
+			const FB_SIZE_T pos = m_relations.getCount();
+			RelationInfo& info = m_relations.add();
+
+			info.relID = relID;
+			info.pending = MAX((pointerPages + SWEEP_RANGE_POINTERS - 1) / SWEEP_RANGE_POINTERS, 1);
+
+			for (ULONG n = 0; n < info.pending; n++)
+			{
+				Item item;
+				item.relation = pos;
+				item.ppFrom = n * SWEEP_RANGE_POINTERS;
+				item.ppTo = (n == info.pending - 1) ? 0 : (n + 1) * SWEEP_RANGE_POINTERS;
+				m_items.add(item);
+			}
+		}
+
+		bool getItem(Item& item, USHORT& relID)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_failed || m_next >= m_items.getCount())
+				return false;
+
+			item = m_items[m_next++];
+
+			RelationInfo& info = m_relations[item.relation];
+			if (!info.clock)
+				info.clock = fb_utils::query_performance_counter();
+
+			relID = info.relID;
+			return true;
+		}
+
+		void itemDone(const Item& item, const RuntimeStatistics& base, const RuntimeStatistics& stats)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			RelationInfo& info = m_relations[item.relation];
+			info.stats.adjust(base, stats);
+
+			if (!--info.pending)
+				m_finished.add(item.relation);
+		}
+
+		void report(thread_db* tdbb, TraceSweepEvent* traceSweep)
+		{
+			// Report relations swept completely since the last call
+
+			while (true)
+			{
+				RelationInfo* info;
+
+				{ // scope
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+					if (m_finished.isEmpty())
+						return;
+
+					info = &m_relations[m_finished.pop()];
+				}
+
+				jrd_rel* const relation = MET_lookup_relation_id(tdbb, info->relID, false);
+				if (relation)
+				{
+					traceSweep->endSweepRelation(relation, info->stats,
+						fb_utils::query_performance_counter() - info->clock);
+				}
+			}
+		}
+
+		void fail()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			m_failed = true;
+		}
+
+		bool failed()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return m_failed;
+		}
+
+	private:
+		Database* const m_dbb;
+		Mutex m_mutex;
+		Array<Item> m_items;
+		FB_SIZE_T m_next;
+		ObjectsArray<RelationInfo> m_relations;
+		Array<FB_SIZE_T> m_finished;
+		bool m_failed;
+	};
+} // namespace
+
+
 inline void clearRecordStack(RecordStack& stack)
 {
 /**************************************
@@ -752,10 +902,25 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 		!(rpb->rpb_flags & (rpb_deleted | rpb_damaged)) &&
 		(rpb->rpb_b_page == 0 || rpb->rpb_transaction_nr >= oldest_snapshot))
 	{
-		if (gcPolicyBackground && rpb->rpb_b_page)
-			notify_garbage_collector(tdbb, rpb);
+		// The garbage collector can't purge the back versions yet, but some
+		// of them could be invisible to every snapshot already
 
-		return true;
+		if (!(state == tra_committed && rpb->rpb_b_page &&
+				(attachment->att_flags & ATT_garbage_collector) &&
+				purge_intermediate(tdbb, rpb, transaction)))
+		{
+			if (gcPolicyBackground && rpb->rpb_b_page)
+				notify_garbage_collector(tdbb, rpb);
+
+			return true;
+		}
+
+		// The primary version was released, look at it all over again
+
+		if (!DPM_get(tdbb, rpb, LCK_read))
+			return false;
+
+		state = TRA_snapshot_state(tdbb, transaction, rpb->rpb_transaction_nr);
 	}
 
 	// OK, something about the record is fishy.  Loop thru versions until a
@@ -764,6 +929,7 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 
 	RuntimeStatistics::Accumulator backversions(tdbb, relation,
 												RuntimeStatistics::RECORD_BACKVERSION_READS);
+	ULONG depth = 0;
 
 	// First, save the record indentifying information to be restored on exit
 
@@ -1012,6 +1178,7 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 				}
 
 				++backversions;
+				++depth;
 				break;
 			}
 			else
@@ -1078,6 +1245,7 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 					}
 
 					++backversions;
+					++depth;
 				}
 			}
 			break;
@@ -1175,6 +1343,15 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 					// VIO_chase_record_version
 					notify_garbage_collector(tdbb, rpb);
 				}
+				else if (gcPolicyBackground && (attachment->att_flags & ATT_notify_gc) &&
+					(rpb->rpb_flags & rpb_chained) && depth >= INTERMEDIATE_GC_DEPTH &&
+					oldest_snapshot > 1)
+				{
+					// Long way down to the version we see. Let the garbage collector
+					// visit the page even though the oldest snapshot doesn't allow
+					// to purge the record, maybe nobody needs the versions we skipped.
+					notify_garbage_collector(tdbb, rpb, oldest_snapshot - 1);
+				}
 
 				return true;
 			}
@@ -1908,7 +2085,10 @@ void VIO_erase(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 	// VIO_erase
 	if ((tdbb->getDatabase()->dbb_flags & DBB_gc_background) && !rpb->rpb_relation->isTemporary())
+	{
 		notify_garbage_collector(tdbb, rpb, transaction->tra_number);
+		notify_index_changes(tdbb, rpb->rpb_relation);
+	}
 }
 
 
@@ -2891,6 +3071,7 @@ void VIO_modify(thread_db* tdbb, record_param* org_rpb, record_param* new_rpb, j
 		!org_rpb->rpb_relation->isTemporary())
 	{
 		notify_garbage_collector(tdbb, org_rpb, transaction->tra_number);
+		notify_index_changes(tdbb, org_rpb->rpb_relation);
 	}
 }
 
@@ -3483,6 +3664,10 @@ void VIO_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 	if (transaction->tra_flags & TRA_autocommit)
 		transaction->tra_flags |= TRA_perform_autocommit;
+
+	// VIO_store
+	if ((tdbb->getDatabase()->dbb_flags & DBB_gc_background) && !relation->isTemporary())
+		notify_index_changes(tdbb, relation);
 }
 
 
@@ -3515,6 +3700,13 @@ bool VIO_sweep(thread_db* tdbb, jrd_tra* transaction, TraceSweepEvent* traceSwee
 	// hvlad: restore tdbb->transaction since it can be used later
 	tdbb->setTransaction(transaction);
 
+	// Superserver may sweep in several threads sharing the database
+
+	const int workerCount = MIN(dbb->dbb_config->getSweepWorkers(), MAX_SWEEP_WORKERS);
+
+	if (workerCount > 1 && (dbb->dbb_flags & DBB_shared))
+		return sweep_parallel(tdbb, transaction, traceSweep, workerCount);
+
 	record_param rpb;
 	rpb.rpb_record = NULL;
 	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
@@ -4321,6 +4513,91 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+static bool garbage_collect_pages(thread_db* tdbb, record_param& rpb, jrd_tra*& transaction,
+	jrd_rel* relation, PageBitmap* gc_bitmap, bool& collected)
+{
+/**************************************
+ *
+ *	g a r b a g e _ c o l l e c t _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Garbage collect the data pages of a relation marked
+ *	in the given bitmap, releasing the bitmap afterwards.
+ *	Start the transaction used for garbage collection if
+ *	not started yet. Set collected if some page was
+ *	processed. Return false if the garbage collector
+ *	is requested to finish up.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	AutoPtr<PageBitmap> bitmap(gc_bitmap);
+
+	// Express interest in the relation to prevent it from being deleted
+	// out from under us while garbage collection is in-progress.
+
+	jrd_rel::GCShared gcGuard(tdbb, relation);
+	if (!gcGuard.gcEnabled())
+		return true;
+
+	rpb.rpb_relation = relation;
+
+	while (bitmap->getFirst())
+	{
+		const ULONG dp_sequence = bitmap->current();
+
+		if (!(dbb->dbb_flags & DBB_garbage_collector))
+			return false;
+
+		bitmap->clear(dp_sequence);
+		collected = true;
+
+		if (!transaction)
+		{
+			// Start a "precommitted" transaction by using read-only,
+			// read committed. Of particular note is the absence of a
+			// transaction lock which means the transaction does not
+			// inhibit garbage collection by its very existence.
+
+			transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+			tdbb->setTransaction(transaction);
+		}
+		else
+		{
+			// Refresh our notion of the oldest transactions for
+			// efficient garbage collection. This is very cheap.
+
+			transaction->tra_oldest = dbb->dbb_oldest_transaction;
+			transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+		}
+
+		rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
+		const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
+
+		// Attempt to garbage collect all records on the data page.
+
+		while (VIO_next_record(tdbb, &rpb, transaction, NULL, true))
+		{
+			CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+			if (!(dbb->dbb_flags & DBB_garbage_collector))
+				return false;
+
+			if (relation->rel_flags & (REL_deleting | REL_gc_disabled))
+				return true;
+
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
+
+			if (rpb.rpb_number >= last)
+				break;
+		}
+	}
+
+	return true;
+}
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -4337,255 +4614,324 @@ void Database::garbage_collector(Database* dbb)
  *	improve query response time and throughput.
  *
  **************************************/
-	FbLocalStatus status_vector;
+	VIO_run_background(dbb, "Garbage Collector", ATT_garbage_collector, garbage_collector_main, NULL);
+
+	dbb->dbb_flags &= ~(DBB_garbage_collector | DBB_gc_active | DBB_gc_pending);
 
 	try
 	{
-		UserId user;
-		user.setUserName("Garbage Collector");
+		// Notify the finalization caller that we're finishing.
+		if (dbb->dbb_flags & DBB_gc_starting)
+		{
+			dbb->dbb_flags &= ~DBB_gc_starting;
+			dbb->dbb_gc_init.release();
+		}
+	}
+	catch (const Firebird::Exception& ex)
+	{
+		dbb->exceptionHandler(ex, NULL);
+	}
+}
 
-		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb);
-		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
-		attachment->setStable(sAtt);
-		attachment->att_filename = dbb->dbb_filename;
-		attachment->att_flags |= ATT_garbage_collector;
-		attachment->att_user = &user;
 
-		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
-		tdbb->tdbb_quantum = SWEEP_QUANTUM;
-		tdbb->tdbb_flags = TDBB_sweeper;
+void Database::gc_worker(Database* dbb)
+{
+/**************************************
+ *
+ *	g c _ w o r k e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Helper of the garbage collector thread.
+ *
+ **************************************/
+	VIO_run_background(dbb, "Garbage Collector", ATT_garbage_collector, gc_worker_main, NULL);
+}
 
-		record_param rpb;
-		rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
-		rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
 
-		jrd_rel* relation = NULL;
-		jrd_tra* transaction = NULL;
+static void garbage_collector_main(thread_db* tdbb, void* /*arg*/)
+{
+/**************************************
+ *
+ *	g a r b a g e _ c o l l e c t o r _ m a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Main loop of the garbage collector thread.
+ *
+ *	If configured, start helper threads which take
+ *	their share of the marked pages in parallel.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	Jrd::Attachment* const attachment = tdbb->getAttachment();
 
-		AutoPtr<GarbageCollector> gc(FB_NEW_POOL(*attachment->att_pool) GarbageCollector(
-			*attachment->att_pool, dbb));
+	record_param rpb;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
 
-		try
-		{
-			LCK_init(tdbb, LCK_OWNER_attachment);
-			INI_init(tdbb);
-			INI_init2(tdbb);
-			PAG_header(tdbb, true);
-			PAG_attachment_id(tdbb);
-			TRA_init(attachment);
+	jrd_rel* relation = NULL;
+	jrd_tra* transaction = NULL;
 
-			dbb->dbb_garbage_collector = gc;
+	AutoPtr<GarbageCollector> gc(FB_NEW_POOL(*attachment->att_pool) GarbageCollector(
+		*attachment->att_pool, dbb));
 
-			sAtt->initDone();
+	HalfStaticArray<ThreadFinishSync<Database*>*, 4> workers;
 
-			// Notify our creator that we have started
-			dbb->dbb_flags |= DBB_garbage_collector;
-			dbb->dbb_flags &= ~DBB_gc_starting;
-			dbb->dbb_gc_init.release();
+	try
+	{
+		dbb->dbb_garbage_collector = gc;
 
-			// The garbage collector flag is cleared to request the thread
-			// to finish up and exit.
+		// Notify our creator that we have started
+		dbb->dbb_flags |= DBB_garbage_collector;
+		dbb->dbb_flags &= ~DBB_gc_starting;
+		dbb->dbb_gc_init.release();
 
-			bool flush = false;
+		// Start the helpers. Failure to start any of them
+		// is not fatal, we just have less hands to work.
 
-			while (dbb->dbb_flags & DBB_garbage_collector)
-			{
-				dbb->dbb_flags |= DBB_gc_active;
+		const int workerCount = MIN(dbb->dbb_config->getGCWorkers(), MAX_GC_WORKERS);
 
-				// If background thread activity has been suspended because
-				// of I/O errors then idle until the condition is cleared.
-				// In particular, make worker threads perform their own
-				// garbage collection so that errors are reported to users.
+		for (int n = 1; n < workerCount; n++)
+		{
+			ThreadFinishSync<Database*>* const worker =
+				FB_NEW_POOL(*dbb->dbb_permanent) ThreadFinishSync<Database*>(
+					*dbb->dbb_permanent, Database::gc_worker, THREAD_medium);
 
-				if (dbb->dbb_flags & DBB_suspend_bgio)
-				{
-					EngineCheckout cout(tdbb, FB_FUNCTION);
-					dbb->dbb_gc_sem.tryEnter(10);
-					continue;
-				}
+			try
+			{
+				worker->run(dbb);
+			}
+			catch (const Firebird::Exception& ex)
+			{
+				delete worker;
+				iscLogException("cannot start garbage collector helper thread", ex);
+				break;
+			}
 
-				// Scan relation garbage collection bitmaps for candidate data pages.
-				// Express interest in the relation to prevent it from being deleted
-				// out from under us while garbage collection is in-progress.
+			workers.add(worker);
+		}
 
-				bool found = false, gc_exit = false;
-				relation = NULL;
+		// With helpers around, hand out the pages in batches
+		// so the backlog of a large relation is shared too.
 
-				USHORT relID;
-				PageBitmap* gc_bitmap = NULL;
+		const ULONG batchPages = workers.hasData() ? GC_BATCH_PAGES : 0;
 
-				if ((dbb->dbb_flags & DBB_gc_pending) &&
-					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID)))
-				{
-					relation = MET_lookup_relation_id(tdbb, relID, false);
-					if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
-					{
-						delete gc_bitmap;
-						gc_bitmap = NULL;
-						gc->removeRelation(relID);
-					}
+		// The garbage collector flag is cleared to request the thread
+		// to finish up and exit.
 
-					if (gc_bitmap)
-					{
-						jrd_rel::GCShared gcGuard(tdbb, relation);
-						if (!gcGuard.gcEnabled())
-							continue;
+		bool flush = false;
+
+		while (dbb->dbb_flags & DBB_garbage_collector)
+		{
+			dbb->dbb_flags |= DBB_gc_active;
 
-						rpb.rpb_relation = relation;
+			// If background thread activity has been suspended because
+			// of I/O errors then idle until the condition is cleared.
+			// In particular, make worker threads perform their own
+			// garbage collection so that errors are reported to users.
 
-						while (gc_bitmap->getFirst())
-						{
-							const ULONG dp_sequence = gc_bitmap->current();
-
-							if (!(dbb->dbb_flags & DBB_garbage_collector))
-							{
-								gc_exit = true;
-								break;
-							}
-
-							if (gc_exit)
-								break;
-
-							gc_bitmap->clear(dp_sequence);
-
-							if (!transaction)
-							{
-								// Start a "precommitted" transaction by using read-only,
-								// read committed. Of particular note is the absence of a
-								// transaction lock which means the transaction does not
-								// inhibit garbage collection by its very existence.
-
-								transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
-								tdbb->setTransaction(transaction);
-							}
-							else
-							{
-								// Refresh our notion of the oldest transactions for
-								// efficient garbage collection. This is very cheap.
-
-								transaction->tra_oldest = dbb->dbb_oldest_transaction;
-								transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
-							}
-
-							found = flush = true;
-							rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
-							const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
-
-							// Attempt to garbage collect all records on the data page.
-
-							bool rel_exit = false;
-
-							while (VIO_next_record(tdbb, &rpb, transaction, NULL, true))
-							{
-								CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
-
-								if (!(dbb->dbb_flags & DBB_garbage_collector))
-								{
-									gc_exit = true;
-									break;
-								}
-
-								if (relation->rel_flags & REL_deleting)
-								{
-									rel_exit = true;
-									break;
-								}
-
-								if (relation->rel_flags & REL_gc_disabled)
-								{
-									rel_exit = true;
-									break;
-								}
-
-								if (--tdbb->tdbb_quantum < 0)
-									JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
-
-								if (rpb.rpb_number >= last)
-									break;
-							}
-
-							if (gc_exit || rel_exit)
-								break;
-						}
+			if (dbb->dbb_flags & DBB_suspend_bgio)
+			{
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				dbb->dbb_gc_sem.tryEnter(10);
+				continue;
+			}
 
-						if (gc_exit)
-							break;
+			// Scan relation garbage collection bitmaps for candidate data pages.
 
-						delete gc_bitmap;
-						gc_bitmap = NULL;
-					}
-				}
+			bool found = false;
+			relation = NULL;
 
-				// If there's more work to do voluntarily ask to be rescheduled.
-				// Otherwise, wait for event notification.
+			USHORT relID;
+			PageBitmap* gc_bitmap = NULL;
 
-				if (found)
+			if ((dbb->dbb_flags & DBB_gc_pending) &&
+				(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID, batchPages)))
+			{
+				relation = MET_lookup_relation_id(tdbb, relID, false);
+				if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
 				{
-					JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
+					delete gc_bitmap;
+					gc_bitmap = NULL;
+					gc->removeRelation(relID);
 				}
-				else
+
+				if (gc_bitmap)
 				{
-					dbb->dbb_flags &= ~DBB_gc_pending;
+					// Let the helpers join if there's more to do
+
+					if (workers.hasData() && gc->getBacklog())
+						dbb->dbb_gc_workers_sem.release(workers.getCount());
+
+					bool collected = false;
+					const bool proceed =
+						garbage_collect_pages(tdbb, rpb, transaction, relation, gc_bitmap, collected);
+
+					if (collected)
+						found = flush = true;
+
+					if (!proceed)
+						break;
+				}
+			}
+
+			// Refresh index statistics of a relation changed significantly
+			// since the last refresh. Index pages are only read latched,
+			// so writers are not blocked meanwhile.
 
-					if (flush)
+			if (!found && gc->getStatsRelation(relID))
+			{
+				relation = MET_lookup_relation_id(tdbb, relID, false);
+				if (relation && !(relation->rel_flags & (REL_deleted | REL_deleting)))
+				{
+					try
 					{
-						// As a last resort, flush garbage collected pages to
-						// disk. This isn't strictly necessary but contributes
-						// to the supply of free pages available for user
-						// transactions. It also reduces the likelihood of
-						// orphaning free space on lower precedence pages that
-						// haven't been written if a crash occurs.
-
-						CCH_flush(tdbb, FLUSH_SWEEP, 0);
-						flush = false;
+						ThreadStatusGuard temp_status(tdbb);
+						gc->statsRefreshed(relID, IDX_refresh_statistics(tdbb, relation));
 					}
+					catch (const Firebird::Exception&)
+					{} // try again after further changes
 
-					dbb->dbb_flags &= ~DBB_gc_active;
-					EngineCheckout cout(tdbb, FB_FUNCTION);
-					dbb->dbb_gc_sem.tryEnter(10);
+					found = true;
 				}
 			}
-		}
-		catch (const Firebird::Exception& ex)
-		{
-			ex.stuffException(&status_vector);
-			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
-			// continue execution to clean up
-		}
-
-		delete rpb.rpb_record;
 
-		dbb->dbb_garbage_collector = NULL;
+			// If there's more work to do voluntarily ask to be rescheduled.
+			// Otherwise, wait for event notification.
 
-		if (transaction)
-			TRA_commit(tdbb, transaction, false);
+			if (found)
+			{
+				JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
+			}
+			else
+			{
+				dbb->dbb_flags &= ~DBB_gc_pending;
 
-		Monitoring::cleanupAttachment(tdbb);
-		attachment->releaseLocks(tdbb);
-		LCK_fini(tdbb, LCK_OWNER_attachment);
+				if (flush)
+				{
+					// As a last resort, flush garbage collected pages to
+					// disk. This isn't strictly necessary but contributes
+					// to the supply of free pages available for user
+					// transactions. It also reduces the likelihood of
+					// orphaning free space on lower precedence pages that
+					// haven't been written if a crash occurs.
+
+					CCH_flush(tdbb, FLUSH_SWEEP, 0);
+					flush = false;
+				}
 
-		attachment->releaseRelations(tdbb);
-	}	// try
+				dbb->dbb_flags &= ~DBB_gc_active;
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+				dbb->dbb_gc_sem.tryEnter(10);
+			}
+		}
+	}
 	catch (const Firebird::Exception& ex)
 	{
-		dbb->exceptionHandler(ex, NULL);
+		FbLocalStatus status_vector;
+		ex.stuffException(&status_vector);
+		iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+		// continue execution to clean up
 	}
 
-	dbb->dbb_flags &= ~(DBB_garbage_collector | DBB_gc_active | DBB_gc_pending);
+	// Helpers use our GarbageCollector, wait for them to finish first
 
-	try
+	if (workers.hasData())
 	{
-		// Notify the finalization caller that we're finishing.
-		if (dbb->dbb_flags & DBB_gc_starting)
-		{
-			dbb->dbb_flags &= ~DBB_gc_starting;
-			dbb->dbb_gc_init.release();
+		dbb->dbb_flags &= ~DBB_garbage_collector;
+		dbb->dbb_gc_workers_sem.release(workers.getCount());
+
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		for (FB_SIZE_T i = 0; i < workers.getCount(); i++)
+		{
+			workers[i]->waitForCompletion();
+			delete workers[i];
+		}
+	}
+
+	delete rpb.rpb_record;
+
+	dbb->dbb_garbage_collector = NULL;
+
+	if (transaction)
+		TRA_commit(tdbb, transaction, false);
+}
+
+
+static void gc_worker_main(thread_db* tdbb, void* /*arg*/)
+{
+/**************************************
+ *
+ *	g c _ w o r k e r _ m a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take batches of marked data pages and garbage
+ *	collect them, until the garbage collector
+ *	finishes up.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	record_param rpb;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+
+	jrd_tra* transaction = NULL;
+	GarbageCollector* const gc = dbb->dbb_garbage_collector;
+
+	try
+	{
+		while (dbb->dbb_flags & DBB_garbage_collector)
+		{
+			USHORT relID;
+			PageBitmap* gc_bitmap = NULL;
+
+			if (!(dbb->dbb_flags & DBB_suspend_bgio) && (dbb->dbb_flags & DBB_gc_pending) &&
+				(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID, GC_BATCH_PAGES)))
+			{
+				jrd_rel* const relation = MET_lookup_relation_id(tdbb, relID, false);
+				if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
+				{
+					delete gc_bitmap;
+					gc->removeRelation(relID);
+					continue;
+				}
+
+				bool collected = false;
+				if (!garbage_collect_pages(tdbb, rpb, transaction, relation, gc_bitmap, collected))
+					break;
+
+				if (collected)
+				{
+					JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
+					continue;
+				}
+			}
+
+			// Nothing to do, wait for the garbage collector to wake us up
+
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+			dbb->dbb_gc_workers_sem.tryEnter(10);
 		}
 	}
 	catch (const Firebird::Exception& ex)
 	{
-		dbb->exceptionHandler(ex, NULL);
+		FbLocalStatus status_vector;
+		ex.stuffException(&status_vector);
+		iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+		// continue execution to clean up
 	}
+
+	delete rpb.rpb_record;
+
+	if (transaction)
+		TRA_commit(tdbb, transaction, false);
 }
 
 
@@ -5051,6 +5397,49 @@ static void notify_garbage_collector(thread_db* tdbb, record_param* rpb, TraNumb
 }
 
 
+static void notify_index_changes(thread_db* tdbb, jrd_rel* relation)
+{
+/**************************************
+ *
+ *	n o t i f y _ i n d e x _ c h a n g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Count a record change of a relation. The
+ *	counts are passed to the garbage collector
+ *	in batches, it refreshes index statistics
+ *	of relations changed significantly.
+ *
+ **************************************/
+	const ULONG CHANGES_BATCH = 256;
+
+	if (relation->isSystem() || relation->rel_mod_count.exchangeAdd(1) + 1 < CHANGES_BATCH)
+		return;
+
+	// Several attachments may reach the batch size at once, only one of
+	// them takes the accumulated count
+	const ULONG count = (ULONG) relation->rel_mod_count.setValue(0);
+
+	if (!count)
+		return;
+
+	Database* const dbb = tdbb->getDatabase();
+
+	if (dbb->dbb_flags & DBB_suspend_bgio)
+		return;
+
+	GarbageCollector* gc = dbb->dbb_garbage_collector;
+	if (gc && gc->addChanges(relation->rel_id, count))
+	{
+		dbb->dbb_flags |= DBB_gc_pending;
+
+		if (!(dbb->dbb_flags & DBB_gc_active))
+			dbb->dbb_gc_sem.release();
+	}
+}
+
+
 static int prepare_update(	thread_db*		tdbb,
 							jrd_tra*		transaction,
 							TraNumber		commit_tid_read,
@@ -5557,6 +5946,228 @@ static void purge(thread_db* tdbb, record_param* rpb)
 }
 
 
+static bool purge_intermediate(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
+{
+/**************************************
+ *
+ *	p u r g e _ i n t e r m e d i a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get rid of the back versions of a committed record which are too
+ *	young to be purged but which no active snapshot can see anymore.
+ *	The versions still needed by somebody are stored again as complete
+ *	records under the primary version and the old chain is garbage
+ *	collected.  Return false if the record was not touched, otherwise
+ *	the record is released on return.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	jrd_rel* const relation = rpb->rpb_relation;
+
+	// Snapshots are known for the transactions of this process only
+
+	if (!(dbb->dbb_flags & DBB_shared) || relation->isTemporary() ||
+		(rpb->rpb_flags & (rpb_chained | rpb_gc_active)) ||
+		(tdbb->getAttachment()->att_flags & ATT_no_cleanup))
+	{
+		return false;
+	}
+
+	fb_assert(assert_gc_enabled(transaction, relation));
+
+#ifdef VIO_DEBUG
+	VIO_trace(DEBUG_TRACE_ALL,
+		"purge_intermediate (record_param %" QUADFORMAT"d)\n", rpb->rpb_number.getValue());
+#endif
+
+	RuntimeStatistics::Accumulator backversions(tdbb, relation,
+		RuntimeStatistics::RECORD_BACKVERSION_READS);
+
+	// Collect the data of all versions, newest first. The chain is walked
+	// the way VIO_chase_record_version walks delta versions, any surprise
+	// makes us give up.
+
+	const record_param org = *rpb;
+	record_param temp = *rpb;
+
+	HalfStaticArray<Record*, 16> records;
+	HalfStaticArray<TraNumber, 16> writers;
+	bool complete = true;
+
+	try
+	{
+		while (true)
+		{
+			if ((temp.rpb_flags & (rpb_deleted | rpb_damaged | rpb_gc_active)) ||
+				((temp.rpb_flags & rpb_chained) &&
+					TRA_snapshot_state(tdbb, transaction, temp.rpb_transaction_nr) != tra_committed))
+			{
+				CCH_RELEASE(tdbb, &temp.getWindow(tdbb));
+				complete = false;
+				break;
+			}
+
+			temp.rpb_record = NULL;
+			VIO_data(tdbb, &temp, tdbb->getDefaultPool());
+			records.add(temp.rpb_record);
+			writers.add(temp.rpb_transaction_nr);
+
+			if (!temp.rpb_b_page)
+				break;
+
+			temp.rpb_page = temp.rpb_b_page;
+			temp.rpb_line = temp.rpb_b_line;
+
+			if (!DPM_fetch(tdbb, &temp, LCK_read))
+			{
+				complete = false;
+				break;
+			}
+
+			if (!(temp.rpb_flags & rpb_chained))
+			{
+				CCH_RELEASE(tdbb, &temp.getWindow(tdbb));
+				complete = false;
+				break;
+			}
+
+			++backversions;
+
+			// Don't monopolize the server while chasing long back version chains.
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, 0, true);
+		}
+
+		const FB_SIZE_T count = records.getCount();
+
+		HalfStaticArray<bool, 16> needed;
+		bool* const neededFlags = needed.getBuffer(count);
+		memset(neededFlags, 0, count * sizeof(bool));
+
+		FB_SIZE_T staying_count = 0;
+
+		if (complete && count > 1)
+		{
+			dbb->dbb_active_snapshots.markNeeded(writers.begin(), count, neededFlags);
+
+			for (FB_SIZE_T i = 1; i < count; i++)
+			{
+				if (neededFlags[i])
+					staying_count++;
+			}
+		}
+
+		// It's worth the trouble only if more versions go than are stored again
+
+		if (complete && count > 1 && count - 1 - staying_count > staying_count)
+		{
+			// Store the versions still needed, oldest first, as complete records
+
+			RecordStack staying;
+			staying.push(records[0]);
+
+			PageStack stack;
+			record_param store = temp;
+			store.rpb_b_page = 0;
+			store.rpb_b_line = 0;
+			store.rpb_f_page = 0;
+			store.rpb_f_line = 0;
+			store.rpb_prior = NULL;
+
+			const USHORT pageSpaceID = store.getWindow(tdbb).win_page.getPageSpaceID();
+
+			for (FB_SIZE_T i = count - 1; i > 0; i--)
+			{
+				if (!neededFlags[i])
+					continue;
+
+				Record* const record = records[i];
+				const Format* const format = record->getFormat();
+
+				store.rpb_record = record;
+				store.rpb_address = record->getData();
+				store.rpb_length = format->fmt_length;
+				store.rpb_format_number = format->fmt_version;
+				store.rpb_transaction_nr = writers[i];
+				store.rpb_flags = rpb_chained;
+				store.rpb_number = org.rpb_number;
+
+				DPM_store(tdbb, &store, stack, DPM_secondary);
+				stack.push(PageNumber(pageSpaceID, store.rpb_page));
+
+				store.rpb_b_page = store.rpb_page;
+				store.rpb_b_line = store.rpb_line;
+
+				staying.push(record);
+			}
+
+			// Re-fetch the primary version for write and make sure it's still the
+			// same record with the same chain, then hang the new chain under it
+
+			bool relinked = false;
+
+			if (DPM_get(tdbb, rpb, LCK_write))
+			{
+				if (rpb->rpb_transaction_nr == org.rpb_transaction_nr &&
+					rpb->rpb_flags == org.rpb_flags &&
+					rpb->rpb_b_page == org.rpb_b_page && rpb->rpb_b_line == org.rpb_b_line)
+				{
+					if (store.rpb_b_page)
+						CCH_precedence(tdbb, &rpb->getWindow(tdbb), store.rpb_b_page);
+
+					rpb->rpb_b_page = store.rpb_b_page;
+					rpb->rpb_b_line = store.rpb_b_line;
+					rpb->rpb_flags &= ~(rpb_delta | rpb_gc_active);
+					CCH_MARK(tdbb, &rpb->getWindow(tdbb));
+					DPM_rewrite_header(tdbb, rpb);
+					relinked = true;
+				}
+
+				CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
+			}
+
+			// Remove either the old chain or, if somebody was faster, the copies
+			// just stored. The data of the versions needed stays anyway, so the
+			// index entries and blobs of the removed versions only are released.
+
+			record_param going = org;
+			going.rpb_prior = NULL;
+
+			if (relinked)
+			{
+				if (org.rpb_flags & rpb_delta)
+					going.rpb_prior = records[0];
+
+				tdbb->bumpRelStats(RuntimeStatistics::RECORD_PURGES, relation->rel_id);
+			}
+			else
+			{
+				going.rpb_b_page = store.rpb_b_page;
+				going.rpb_b_line = store.rpb_b_line;
+			}
+
+			if (going.rpb_b_page)
+				garbage_collect(tdbb, &going, org.rpb_page, staying);
+		}
+	}
+	catch (const Firebird::Exception&)
+	{
+		for (Record** iter = records.begin(); iter != records.end(); ++iter)
+			delete *iter;
+
+		throw;
+	}
+
+	for (Record** iter = records.begin(); iter != records.end(); ++iter)
+		delete *iter;
+
+	return true;
+}
+
+
 static void replace_record(thread_db*		tdbb,
 						   record_param*	rpb,
 						   PageStack*		stack,
@@ -5682,6 +6293,79 @@ static void refresh_fk_fields(thread_db* tdbb, Record* old_rec, record_param* cu
 }
 
 
+bool VIO_run_background(Database* dbb, const char* userName, ULONG attFlags,
+	VioBackgroundRoutine* routine, void* arg)
+{
+/**************************************
+ *
+ *	V I O _ r u n _ b a c k g r o u n d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Create a system attachment for a background
+ *	thread of the engine, run the routine within
+ *	it and release the attachment afterwards.
+ *	Return false if the attachment could not be
+ *	initialized or the routine failed.
+ *
+ **************************************/
+	FbLocalStatus status_vector;
+	bool success = false;
+
+	try
+	{
+		UserId user;
+		user.setUserName(userName);
+
+		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb);
+		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
+		attachment->setStable(sAtt);
+		attachment->att_filename = dbb->dbb_filename;
+		attachment->att_flags |= attFlags;
+		attachment->att_user = &user;
+
+		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
+		tdbb->tdbb_quantum = SWEEP_QUANTUM;
+		tdbb->tdbb_flags = TDBB_sweeper;
+
+		try
+		{
+			LCK_init(tdbb, LCK_OWNER_attachment);
+			INI_init(tdbb);
+			INI_init2(tdbb);
+			PAG_header(tdbb, true);
+			PAG_attachment_id(tdbb);
+			TRA_init(attachment);
+
+			sAtt->initDone();
+
+			routine(tdbb, arg);
+			success = true;
+		}
+		catch (const Firebird::Exception& ex)
+		{
+			ex.stuffException(&status_vector);
+			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+			// continue execution to clean up
+		}
+
+		Monitoring::cleanupAttachment(tdbb);
+		attachment->releaseLocks(tdbb);
+		LCK_fini(tdbb, LCK_OWNER_attachment);
+
+		attachment->releaseRelations(tdbb);
+	}	// try
+	catch (const Firebird::Exception& ex)
+	{
+		success = false;
+		dbb->exceptionHandler(ex, NULL);
+	}
+
+	return success;
+}
+
+
 static SSHORT set_metadata_id(thread_db* tdbb, Record* record, USHORT field_id, drq_type_t dyn_id,
 	const char* name)
 {
@@ -5795,6 +6479,291 @@ static void set_system_flag(thread_db* tdbb, Record* record, USHORT field_id)
 }
 
 
+static bool sweep_parallel(thread_db* tdbb, jrd_tra* transaction, TraceSweepEvent* traceSweep,
+	int workerCount)
+{
+/**************************************
+ *
+ *	s w e e p _ p a r a l l e l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make a garbage collection pass with the help of
+ *	additional threads. Relations are split into ranges
+ *	of pointer pages which are swept by whoever is free.
+ *	Return false if some relation couldn't be swept.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	Jrd::Attachment* const attachment = tdbb->getAttachment();
+	GarbageCollector* const gc = dbb->dbb_garbage_collector;
+
+	SweepTask task(*attachment->att_pool, dbb);
+
+	vec<jrd_rel*>* vector = NULL;
+	for (FB_SIZE_T i = 1; (vector = attachment->att_relations) && i < vector->count(); i++)
+	{
+		jrd_rel* relation = (*vector)[i];
+		if (relation)
+			relation = MET_lookup_relation_id(tdbb, i, false);
+
+		if (relation &&
+			!(relation->rel_flags & (REL_deleted | REL_deleting)) &&
+			!relation->isTemporary() &&
+			relation->getPages(tdbb)->rel_pages)
+		{
+			if (gc)
+				gc->sweptRelation(transaction->tra_oldest_active, relation->rel_id);
+
+			task.addRelation(relation->rel_id, relation->getPages(tdbb)->rel_pages->count());
+		}
+	}
+
+	// Start the helpers. Failure to start any of them is not fatal.
+
+	HalfStaticArray<Thread::Handle, 8> helpers;
+
+	for (int n = 1; n < workerCount; n++)
+	{
+		Thread::Handle handle;
+
+		try
+		{
+			Thread::start(sweep_worker, &task, THREAD_medium, &handle);
+		}
+		catch (const Firebird::Exception& ex)
+		{
+			iscLogException("cannot start sweep helper thread", ex);
+			break;
+		}
+
+		helpers.add(handle);
+	}
+
+	record_param rpb;
+	rpb.rpb_record = NULL;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+
+	try
+	{
+		RuntimeStatistics base(*attachment->att_pool);
+		SweepTask::Item item;
+		USHORT relID;
+
+		while (task.getItem(item, relID))
+		{
+			base.assign(transaction->tra_stats);
+
+			if (!sweep_range(tdbb, transaction, rpb, relID, item.ppFrom, item.ppTo))
+			{
+				task.fail();
+				break;
+			}
+
+			task.itemDone(item, base, transaction->tra_stats);
+			task.report(tdbb, traceSweep);
+		}
+	}
+	catch (const Firebird::Exception&)
+	{
+		task.fail();
+
+		{ // scope
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+
+			for (FB_SIZE_T i = 0; i < helpers.getCount(); i++)
+				Thread::waitForCompletion(helpers[i]);
+		}
+
+		delete rpb.rpb_record;
+		throw;
+	}
+
+	// Helpers may hold locks our attachment waits for, let them finish without us
+
+	{ // scope
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		for (FB_SIZE_T i = 0; i < helpers.getCount(); i++)
+			Thread::waitForCompletion(helpers[i]);
+	}
+
+	delete rpb.rpb_record;
+
+	task.report(tdbb, traceSweep);
+
+	return !task.failed();
+}
+
+
+static bool sweep_range(thread_db* tdbb, jrd_tra* transaction, record_param& rpb,
+	USHORT relID, ULONG ppFrom, ULONG ppTo)
+{
+/**************************************
+ *
+ *	s w e e p _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Sweep records of a relation stored on the data pages
+ *	of pointer pages from ppFrom up to (not including)
+ *	ppTo, or up to the end of relation if ppTo is zero.
+ *	Return false if garbage collection of the relation
+ *	is disabled or its pages are not known.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	jrd_rel* const relation = MET_lookup_relation_id(tdbb, relID, false);
+
+	if (!relation || (relation->rel_flags & (REL_deleted | REL_deleting)))
+		return true;
+
+	// The range was taken from the pointer pages known to the sweeping
+	// attachment, don't report it as swept if we don't know them
+
+	if (!relation->getPages(tdbb)->rel_pages)
+	{
+		DPM_scan_pages(tdbb);
+
+		if (!relation->getPages(tdbb)->rel_pages)
+			return false;
+	}
+
+	jrd_rel::GCShared gcGuard(tdbb, relation);
+	if (!gcGuard.gcEnabled())
+		return false;
+
+	const SINT64 ppRecords = (SINT64) dbb->dbb_dp_per_pp * dbb->dbb_max_records;
+	const RecordNumber last((SINT64) ppTo * ppRecords);
+
+	rpb.rpb_relation = relation;
+	rpb.rpb_number.setValue((SINT64) ppFrom * ppRecords + BOF_NUMBER);
+	rpb.rpb_org_scans = relation->rel_scan_count++;
+
+	try
+	{
+		while (VIO_next_record(tdbb, &rpb, transaction, 0, false))
+		{
+			CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+			if (relation->rel_flags & REL_deleting)
+				break;
+
+			if (ppTo && rpb.rpb_number >= last)
+				break;
+
+			if (--tdbb->tdbb_quantum < 0)
+				JRD_reschedule(tdbb, SWEEP_QUANTUM, true);
+
+			transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+		}
+	}
+	catch (const Firebird::Exception&)
+	{
+		--relation->rel_scan_count;
+		throw;
+	}
+
+	--relation->rel_scan_count;
+
+	return true;
+}
+
+
+static THREAD_ENTRY_DECLARE sweep_worker(THREAD_ENTRY_PARAM arg)
+{
+/**************************************
+ *
+ *	s w e e p _ w o r k e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Helper thread of parallel sweep.
+ *
+ **************************************/
+	SweepTask* const task = static_cast<SweepTask*>(arg);
+
+	if (!VIO_run_background(task->getDatabase(), "Sweeper", 0, sweep_worker_main, task))
+		task->fail();
+
+	return 0;
+}
+
+
+static void sweep_worker_main(thread_db* tdbb, void* arg)
+{
+/**************************************
+ *
+ *	s w e e p _ w o r k e r _ m a i n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Sweep ranges of relations using own transaction
+ *	until there's nothing left.
+ *
+ **************************************/
+	SweepTask* const task = static_cast<SweepTask*>(arg);
+	Database* const dbb = tdbb->getDatabase();
+	Jrd::Attachment* const attachment = tdbb->getAttachment();
+
+	record_param rpb;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+
+	jrd_tra* transaction = NULL;
+
+	try
+	{
+		// Our transaction is started after the one of the sweeping attachment,
+		// thus we clean up at least what it's going to when advancing the OIT.
+
+		transaction = TRA_start_sweep(tdbb);
+		tdbb->setTransaction(transaction);
+
+		// Relations of a new attachment don't know their pointer pages yet
+
+		DPM_scan_pages(tdbb);
+
+		RuntimeStatistics base(*attachment->att_pool);
+		SweepTask::Item item;
+		USHORT relID;
+
+		while (task->getItem(item, relID))
+		{
+			base.assign(transaction->tra_stats);
+
+			if (!sweep_range(tdbb, transaction, rpb, relID, item.ppFrom, item.ppTo))
+			{
+				task->fail();
+				break;
+			}
+
+			task->itemDone(item, base, transaction->tra_stats);
+		}
+	}
+	catch (const Firebird::Exception& ex)
+	{
+		task->fail();
+
+		FbLocalStatus status_vector;
+		ex.stuffException(&status_vector);
+		iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+		// continue execution to clean up
+	}
+
+	delete rpb.rpb_record;
+
+	if (transaction)
+		TRA_commit(tdbb, transaction, false);
+}
+
+
 void VIO_update_in_place(thread_db* tdbb,
 							jrd_tra* transaction, record_param* org_rpb, record_param* new_rpb)
 {
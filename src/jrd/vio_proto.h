@@ -27,6 +27,7 @@
 #define JRD_VIO_PROTO_H
 
 namespace Jrd {
+	class Database;
 	class jrd_rel;
 	class jrd_tra;
 	class Record;
@@ -37,6 +38,9 @@ namespace Jrd {
 	class TraceSweepEvent;
 }
 
+// Routine of a background thread, run within its own system attachment
+typedef void VioBackgroundRoutine(Jrd::thread_db*, void*);
+
 void	VIO_backout(Jrd::thread_db*, Jrd::record_param*, const Jrd::jrd_tra*);
 bool	VIO_chase_record_version(Jrd::thread_db*, Jrd::record_param*,
 									Jrd::jrd_tra*, MemoryPool*, bool, bool);
@@ -55,6 +59,7 @@ void	VIO_modify(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jr
 bool	VIO_next_record(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*, MemoryPool*, bool);
 Jrd::Record*	VIO_record(Jrd::thread_db*, Jrd::record_param*, const Jrd::Format*, MemoryPool*);
 bool	VIO_refetch_record(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*, bool, bool);
+bool	VIO_run_background(Jrd::Database*, const char*, ULONG, VioBackgroundRoutine*, void*);
 void	VIO_store(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
 bool	VIO_sweep(Jrd::thread_db*, Jrd::jrd_tra*, Jrd::TraceSweepEvent*);
 void	VIO_garbage_collect_idx(Jrd::thread_db*, Jrd::jrd_tra*, Jrd::record_param*, Jrd::Record*);
@@ -56,6 +56,7 @@
 #include "../common/classes/init.h"
 #include "../common/classes/timestamp.h"
 #include "../common/os/os_utils.h"
+#include "../common/utils_proto.h"
 
 #include <stdio.h>
 #include <errno.h>
@@ -142,6 +143,9 @@ const SRQ_PTR DUMMY_OWNER = -1;
 const SLONG HASH_MIN_SLOTS	= 101;
 const SLONG HASH_MAX_SLOTS	= 65521;
 const USHORT HISTORY_BLOCKS	= 256;
+const ULONG WAKEUP_MIN_SPINS	= 16;
+const ULONG WAKEUP_MAX_USEC		= 50;	// never spin longer than that
+const ULONG WAKEUP_CLOCK_SPINS	= 64;	// spins between the clock checks
 
 // SRQ_ABS_PTR uses this macro.
 #define SRQ_BASE                    ((UCHAR*) m_sharedMemory->getHeader())
@@ -161,6 +165,21 @@ static const bool compatibility[LCK_max][LCK_max] =
 };
 
 
+// Hint the CPU that we're in a spin-wait loop. This lowers the power
+// consumption and frees the execution resources for the sibling
+// hyper-thread, which might be the very one we're waiting for.
+static inline void spin_pause()
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_pause();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && (defined(__aarch64__) || defined(__arm__))
+	__asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+
 namespace Jrd {
 
 Firebird::GlobalPtr<LockManager::DbLockMgrMap> LockManager::g_lmMap;
@@ -226,6 +245,8 @@ LockManager::LockManager(const Firebird::string& id, RefPtr<const Config> conf)
 	  , m_extents(getPool())
 #endif
 {
+	m_wakeupSpins.setValue(WAKEUP_MIN_SPINS);
+
 	LocalStatus ls;
 	CheckStatusWrapper localStatus(&ls);
 	if (!attach_shared_file(&localStatus))
@@ -794,6 +815,63 @@ bool LockManager::dequeue(const SRQ_PTR request_offset)
 }
 
 
+bool LockManager::testLock(const USHORT series,
+						   const UCHAR* value,
+						   const USHORT length,
+						   UCHAR type,
+						   SRQ_PTR owner_offset)
+{
+/**************************************
+ *
+ *	t e s t L o c k
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a lock could be granted right now
+ *	without actually granting it. This is the same as
+ *	a no-wait enqueue followed by a dequeue, but the lock
+ *	table is acquired once and nothing is allocated or
+ *	linked into the queues.
+ *
+ **************************************/
+	LOCK_TRACE(("LM::testLock (%ld)\n", owner_offset));
+
+	if (!owner_offset)
+		return false;
+
+	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
+
+	const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	if (!owner->own_count)
+		return false;
+
+	ASSERT_ACQUIRED;
+	++(m_sharedMemory->getHeader()->lhb_enqs);
+
+	if (series < LCK_MAX_SERIES)
+		++(m_sharedMemory->getHeader()->lhb_operations[series]);
+	else
+		++(m_sharedMemory->getHeader()->lhb_operations[0]);
+
+	USHORT junk;
+	const lbl* const lock = find_lock(series, value, length, &junk);
+
+	// A missing lock would be created and granted. Otherwise follow the
+	// rules of grant_or_que(): the request must be compatible with the
+	// lock state and must not overtake the pending requests.
+
+	if (!lock || (compatibility[type][lock->lbl_state] &&
+		(type == LCK_null || lock->lbl_pending_lrq_count == 0)))
+	{
+		return true;
+	}
+
+	++(m_sharedMemory->getHeader()->lhb_denies);
+	return false;
+}
+
+
 void LockManager::repost(thread_db* tdbb, lock_ast_t ast, void* arg, SRQ_PTR owner_offset)
 {
 /**************************************
@@ -3226,6 +3304,73 @@ void LockManager::release_request(lrq* request)
 }
 
 
+bool LockManager::spin_for_wakeup(SRQ_PTR owner_offset, SLONG value)
+{
+/**************************************
+ *
+ *	s p i n _ f o r _ w a k e u p
+ *
+ **************************************
+ *
+ * Functional description
+ *	Poll the owner's wakeup event for a short while before going
+ *	to sleep on it. Most lock conflicts are resolved within a few
+ *	microseconds and the blocking owner posts the event while we
+ *	are still here, so the sleep/wakeup round trip through the
+ *	kernel is avoided. The lock table is not held while spinning.
+ *
+ *	The spin budget adapts: it grows after a successful spin and
+ *	shrinks after a futile one, bounded by LockAcquireSpins which
+ *	also enables the feature (as for the mutex spin, this makes
+ *	sense on SMP machines only). Whatever the budget, no more than
+ *	WAKEUP_MAX_USEC microseconds are spent here.
+ *
+ **************************************/
+	if (!m_acquireSpins)
+		return false;
+
+	const ULONG limit = MAX(m_acquireSpins, WAKEUP_MIN_SPINS);
+	const ULONG spins_to_try = MIN((ULONG) m_wakeupSpins.value(), limit);
+
+	bool posted = false;
+
+	{ // scope
+		Firebird::ReadLockGuard guard(m_remapSync, FB_FUNCTION);
+		const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+		const volatile SLONG* const count = &owner->own_wakeup.event_count;
+
+		// The spin is bounded by time as well, the cost of an iteration
+		// differs a lot between CPUs
+		const SINT64 deadline = fb_utils::query_performance_counter() +
+			fb_utils::query_performance_frequency() * WAKEUP_MAX_USEC / 1000000;
+
+		for (ULONG spins = 0; spins < spins_to_try; spins++)
+		{
+			if (*count >= value)
+			{
+				posted = true;
+				break;
+			}
+
+			if ((spins % WAKEUP_CLOCK_SPINS == WAKEUP_CLOCK_SPINS - 1) &&
+				fb_utils::query_performance_counter() > deadline)
+			{
+				break;
+			}
+
+			spin_pause();
+		}
+	}
+
+	if (posted)
+		m_wakeupSpins.setValue(MIN(spins_to_try * 2, limit));
+	else
+		m_wakeupSpins.setValue(MAX(spins_to_try / 2, WAKEUP_MIN_SPINS));
+
+	return posted;
+}
+
+
 bool LockManager::signal_owner(thread_db* tdbb, own* blocking_owner)
 {
 /**************************************
@@ -3882,7 +4027,15 @@ void LockManager::wait_for_request(thread_db* tdbb, lrq* request, SSHORT lck_wai
 
 				{ // scope
 					EngineCheckout cout(tdbb, FB_FUNCTION, true);
-					ret = m_sharedMemory->eventWait(&owner->own_wakeup, value, (timeout - current_time) * 1000000);
+
+					if (spin_for_wakeup(owner_offset, value))
+						ret = FB_SUCCESS;
+					else
+					{
+						owner = (own*) SRQ_ABS_PTR(owner_offset);
+						ret = m_sharedMemory->eventWait(&owner->own_wakeup, value, (timeout - current_time) * 1000000);
+					}
+
 					--m_waitingOwners;
 				}
 			}
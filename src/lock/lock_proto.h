@@ -409,6 +409,7 @@ public:
 	bool convert(thread_db*, Firebird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT, lock_ast_t, void*);
 	UCHAR downgrade(thread_db*, Firebird::CheckStatusWrapper*, const SRQ_PTR);
 	bool dequeue(const SRQ_PTR);
+	bool testLock(const USHORT, const UCHAR*, const USHORT, UCHAR, SRQ_PTR);
 
 	void repost(thread_db*, lock_ast_t, void*, SRQ_PTR);
 	bool cancelWait(SRQ_PTR);
@@ -460,6 +461,7 @@ private:
 	void release_shmem(SRQ_PTR);
 	void release_request(lrq*);
 	bool signal_owner(thread_db*, own*);
+	bool spin_for_wakeup(SRQ_PTR, SLONG);
 
 	void validate_history(const SRQ_PTR history_header);
 	void validate_lhb(const lhb*);
@@ -489,6 +491,7 @@ private:
 	Firebird::Mutex m_localMutex;
 	Firebird::RWLock m_remapSync;
 	Firebird::AtomicCounter m_waitingOwners;
+	Firebird::AtomicCounter m_wakeupSpins;
 
 	ThreadFinishSync<LockManager*> m_cleanupSync;
 	Firebird::Semaphore m_startupSemaphore;